@@ -0,0 +1,156 @@
+/*
+ * image.c - PNG, PPM and raw RGB output for rendered frames.
+ *
+ * The PNG writer is self-contained: image data goes into uncompressed
+ * ("stored") deflate blocks, so no zlib is needed. Files are larger than a
+ * compressing encoder would make them, but every viewer and converter reads
+ * them.
+ */
+
+#include "image.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// --- Pixel Conversion ---
+/**
+ * @brief Converts row y of an ARGB8888 image to packed 8-bit RGB.
+ */
+static void argb_row_to_rgb(const void* pixels, int pitch, int width, int y, unsigned char* rgb) {
+    const uint32_t* row = (const uint32_t*)((const unsigned char*)pixels + (size_t)y * pitch);
+    for (int x = 0; x < width; x++) {
+        rgb[3 * x] = (unsigned char)(row[x] >> 16);
+        rgb[3 * x + 1] = (unsigned char)(row[x] >> 8);
+        rgb[3 * x + 2] = (unsigned char)row[x];
+    }
+}
+
+// --- Raw RGB and PPM ---
+int image_write_rgb(FILE* file, const void* pixels, int width, int height, int pitch) {
+    unsigned char* rgb = (unsigned char*)malloc((size_t)width * 3);
+    if (!rgb) return -1;
+    int status = 0;
+    for (int y = 0; y < height && status == 0; y++) {
+        argb_row_to_rgb(pixels, pitch, width, y, rgb);
+        if (fwrite(rgb, 3, (size_t)width, file) != (size_t)width) status = -1;
+    }
+    free(rgb);
+    return status;
+}
+
+static int write_ppm(FILE* file, const void* pixels, int width, int height, int pitch) {
+    if (fprintf(file, "P6\n%d %d\n255\n", width, height) < 0) return -1;
+    return image_write_rgb(file, pixels, width, height, pitch);
+}
+
+// --- PNG ---
+#define DEFLATE_STORED_MAX 65535    // Largest stored deflate block
+
+static uint32_t crc_table[256];
+
+static void crc_table_init(void) {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crc_table[n] = c;
+    }
+}
+
+static uint32_t crc_update(uint32_t crc, const unsigned char* data, size_t length) {
+    for (size_t i = 0; i < length; i++) crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+static void put_be32(unsigned char* p, uint32_t v) {
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+}
+
+/**
+ * @brief Writes one PNG chunk: length, type, data and the CRC of type + data.
+ */
+static int write_chunk(FILE* file, const char* type, const unsigned char* data, size_t length) {
+    unsigned char header[8], trailer[4];
+    put_be32(header, (uint32_t)length);
+    memcpy(header + 4, type, 4);
+    uint32_t crc = crc_update(0xFFFFFFFFu, header + 4, 4);
+    crc = crc_update(crc, data, length);
+    put_be32(trailer, crc ^ 0xFFFFFFFFu);
+    if (fwrite(header, 1, 8, file) != 8) return -1;
+    if (length > 0 && fwrite(data, 1, length, file) != length) return -1;
+    return fwrite(trailer, 1, 4, file) == 4 ? 0 : -1;
+}
+
+static int write_png(FILE* file, const void* pixels, int width, int height, int pitch) {
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (crc_table[1] == 0) crc_table_init();
+
+    // Scanlines: a filter byte (0, none) followed by the row's RGB triples
+    size_t row_bytes = 1 + (size_t)width * 3;
+    size_t raw_size = row_bytes * height;
+    size_t num_blocks = (raw_size + DEFLATE_STORED_MAX - 1) / DEFLATE_STORED_MAX;
+    if (num_blocks == 0) num_blocks = 1;
+    size_t zlib_size = 2 + raw_size + 5 * num_blocks + 4;
+    unsigned char* raw = (unsigned char*)malloc(raw_size);
+    unsigned char* zlib = (unsigned char*)malloc(zlib_size);
+    if (!raw || !zlib) {
+        free(raw);
+        free(zlib);
+        return -1;
+    }
+    for (int y = 0; y < height; y++) {
+        raw[y * row_bytes] = 0;
+        argb_row_to_rgb(pixels, pitch, width, y, raw + y * row_bytes + 1);
+    }
+
+    // zlib stream of stored blocks, then the Adler-32 of the raw data
+    unsigned char* out = zlib;
+    *out++ = 0x78;
+    *out++ = 0x01;
+    size_t offset = 0;
+    for (size_t b = 0; b < num_blocks; b++) {
+        size_t length = raw_size - offset < DEFLATE_STORED_MAX ? raw_size - offset : DEFLATE_STORED_MAX;
+        *out++ = b + 1 == num_blocks;   // BFINAL on the last block, BTYPE 00
+        *out++ = (unsigned char)length;
+        *out++ = (unsigned char)(length >> 8);
+        *out++ = (unsigned char)~length;
+        *out++ = (unsigned char)(~length >> 8);
+        memcpy(out, raw + offset, length);
+        out += length;
+        offset += length;
+    }
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < raw_size; i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_be32(out, (b << 16) | a);
+
+    unsigned char ihdr[13];
+    put_be32(ihdr, (uint32_t)width);
+    put_be32(ihdr + 4, (uint32_t)height);
+    ihdr[8] = 8;    // Bits per channel
+    ihdr[9] = 2;    // Truecolor RGB
+    ihdr[10] = ihdr[11] = ihdr[12] = 0;     // Deflate, adaptive filtering, no interlace
+
+    int status = fwrite(signature, 1, 8, file) == 8 ? 0 : -1;
+    if (status == 0) status = write_chunk(file, "IHDR", ihdr, sizeof(ihdr));
+    if (status == 0) status = write_chunk(file, "IDAT", zlib, zlib_size);
+    if (status == 0) status = write_chunk(file, "IEND", NULL, 0);
+    free(raw);
+    free(zlib);
+    return status;
+}
+
+int image_write(const char* path, const void* pixels, int width, int height, int pitch) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return -1;
+    size_t length = strlen(path);
+    int is_ppm = length >= 4 && strcmp(path + length - 4, ".ppm") == 0;
+    int status = is_ppm ? write_ppm(file, pixels, width, height, pitch)
+                        : write_png(file, pixels, width, height, pitch);
+    if (fclose(file) != 0) status = -1;
+    return status;
+}
@@ -0,0 +1,24 @@
+/*
+ * image.h - Writes rendered frames to image files.
+ */
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdio.h>
+
+/**
+ * @brief Writes a width x height ARGB8888 image (`pitch` bytes per row) to
+ * `path`: binary PPM when the name ends in ".ppm", PNG otherwise.
+ * @return 0 on success, -1 if the file could not be written.
+ */
+int image_write(const char* path, const void* pixels, int width, int height, int pitch);
+
+/**
+ * @brief Writes the image to an open stream as headerless packed RGB24 rows,
+ * the raw video format encoders read from a pipe.
+ * @return 0 on success, -1 on a write error.
+ */
+int image_write_rgb(FILE* file, const void* pixels, int width, int height, int pitch);
+
+#endif // IMAGE_H
@@ -1,221 +1,1198 @@
 /*
  * main.c - A constantly zooming Mandelbrot set fractal.
  *
- * Cross-compiles on Linux for Windows using the provided framework.
- * This version is extremely optimized, using:
- * 1. Multithreading to use all CPU cores.
- * 2. SIMD (SSE2) instructions to process two pixels simultaneously (on x86).
- * 3. A standard C fallback for non-x86 architectures (like ARM).
- * 4. Periodicity checking to skip calculations for large black areas.
- * 5. Interactive mouse clicks to change the zoom target.
+ * Cross-compiles on Linux for Windows using the provided framework. The
+ * rendering engine lives in renderer.c; this file holds the interactive
+ * viewer, which zooms continuously and takes mouse clicks to change the zoom
+ * target, and the headless renderer (--render) that writes a single frame or
+ * a zoom sequence to image files or a raw video stream without opening a
+ * window.
  */
 
 #define SDL_MAIN_HANDLED
 #include <SDL.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
-#include <pthread.h>     // For multithreading
-#include <SDL_cpuinfo.h> // To get the number of CPU cores
-#include <stdatomic.h>   // For dynamic work scheduling
-
-// --- MODIFIED: Conditionally include SSE2 header only for x86/x64 builds ---
-#if defined(__x86_64__) || defined(__i386__)
-#include <emmintrin.h>   // For SSE2 intrinsics on x86/x64
+#include <pthread.h>    // Writer thread of --frames sequences
+#ifdef _WIN32
+#include <io.h>         // _setmode, for raw frames on stdout
+#include <fcntl.h>
 #endif
+#include "renderer.h"
+#include "image.h"
+#include "trace.h"
+#include "topology.h"
 
 // --- Constants ---
 int SCREEN_WIDTH = 800;
 int SCREEN_HEIGHT = 600;
-const int MAX_ITERATIONS = 255; // Max iterations for Mandelbrot calculation
+const double ZOOM_SPEED = 0.985;    // Zoom factor applied every frame
+
+// --- Iteration Limit ---
+// With `adaptive` set, the limit grows with zoom depth (-ln zoom) and is
+// nudged by how many pixels of the previous frame hit it without being proven
+// periodic, then capped so the next frame's projected work stays in budget.
+typedef struct {
+    int base;           // Limit at zoom 1, or the fixed limit (--max-iter)
+    int adaptive;       // --adaptive-iter
+    double budget;      // Max iterations per frame, 0 for no cap (--iter-budget)
+    double feedback;    // Multiplier driven by the capped-pixel feedback
+    int limit;          // Limit for the frame being rendered
+} IterationLimit;
+
+#define ITER_DEPTH_GAIN  0.5    // Extra base limits per e-fold of zoom
+#define UNDECIDED_HIGH   2e-3   // Raise the limit above this share of undecided pixels
+#define UNDECIDED_LOW    2e-4   // Lower it below this share
+#define ITER_LIMIT_MIN   16
+#define ITER_LIMIT_MAX   (1 << 24)
+
+/**
+ * @brief Chooses the iteration limit for the next frame.
+ * @param last Kernel counters of the previous frame, or NULL for the first one.
+ * @param pixels Pixels in the previous frame.
+ */
+static void update_iteration_limit(IterationLimit* il, double zoom, const KernelStats* last, long pixels) {
+    if (!il->adaptive) {
+        il->limit = il->base;
+        return;
+    }
+
+    // Pixels that hit the limit without cycle detection proving them interior
+    // may simply need more iterations.
+    if (last && pixels > 0) {
+        double undecided = (double)(last->capped - last->cycle_exits) / (double)pixels;
+        if (undecided > UNDECIDED_HIGH) il->feedback *= 1.1;
+        else if (undecided < UNDECIDED_LOW) il->feedback *= 0.95;
+        if (il->feedback < 0.5) il->feedback = 0.5;
+        if (il->feedback > 8.0) il->feedback = 8.0;
+    }
+
+    double depth = zoom < 1.0 ? -log(zoom) : 0.0;
+    double limit = il->base * (1.0 + ITER_DEPTH_GAIN * depth) * il->feedback;
+
+    // Slow pixels cost about as many iterations as the limit, so project the
+    // next frame's work from the last one and scale the limit into budget.
+    if (il->budget > 0 && last && last->iterations > 0 && il->limit > 0) {
+        double projected = (double)last->iterations * limit / il->limit;
+        if (projected > il->budget) limit *= il->budget / projected;
+    }
+
+    if (limit < ITER_LIMIT_MIN) limit = ITER_LIMIT_MIN;
+    if (limit > ITER_LIMIT_MAX) limit = ITER_LIMIT_MAX;
+    il->limit = (int)limit;
+}
 
-// --- Structs ---
-// Simple struct to hold RGB color values
+
+// --- Resolution Scaling ---
+// Keeps render time near a target by rendering into a smaller region of the
+// texture, which SDL_RenderCopy stretches to the window. Cost is roughly
+// proportional to pixel count, i.e. to the square of the linear scale.
 typedef struct {
-    unsigned char r;
-    unsigned char g;
-    unsigned char b;
-} Color;
+    double target_ms;   // Render-time target per frame, 0 disables (--target-ms)
+    double scale;       // Linear scale of the next frame, in [RES_SCALE_MIN, 1]
+} ResolutionScaler;
+
+#define RES_SCALE_MIN   0.25
+#define RES_HEADROOM    0.75    // Scale back up once below this share of the target
+
+/**
+ * @brief Picks the scale of the next frame from the last frame's render time.
+ */
+static void update_resolution_scale(ResolutionScaler* rs, double render_ms) {
+    if (rs->target_ms <= 0.0 || render_ms <= 0.0) return;
+
+    double ideal = rs->scale * sqrt(rs->target_ms / render_ms) * 0.95;
+    if (render_ms > rs->target_ms) {
+        rs->scale = ideal > rs->scale * 0.5 ? ideal : rs->scale * 0.5;
+    } else if (render_ms < rs->target_ms * RES_HEADROOM && ideal > rs->scale) {
+        // Step up gently so one cheap frame doesn't overshoot the budget
+        rs->scale = ideal < rs->scale * 1.1 ? ideal : rs->scale * 1.1;
+    }
+    if (rs->scale < RES_SCALE_MIN) rs->scale = RES_SCALE_MIN;
+    if (rs->scale > 1.0) rs->scale = 1.0;
+}
 
-// Struct to pass arguments to each rendering thread
+
+// --- Frame Queue ---
+// Most frame buffers a queue holds
+#define FRAME_QUEUE_MAX 3
+
+// A frame buffer and the frame it holds
+typedef struct {
+    void* pixels;           // ARGB8888, the queue's `pitch` bytes per row
+    int number;             // Frame number within a sequence
+    FrameRequest request;   // What was rendered
+    int complete;           // 0 for a progressive preview of the frame
+    double acquire_ms;      // Time the producer waited for the frame's buffers
+    double render_ms;       // Time rendering it, over all passes
+    WorkerStats* workers;   // With --stats, the frame's worker counters, else NULL
+} QueuedFrame;
+
+// Bounded queue of frame buffers between a thread that renders frames and
+// one that consumes them. Slots [head, head + queued) hold rendered frames,
+// oldest first; the producer renders into the slot after them as soon as
+// the consumer has released one, so rendering overlaps with consuming.
 typedef struct {
-    void* pixels;
+    QueuedFrame slots[FRAME_QUEUE_MAX];
+    int num_slots;
     int pitch;
-    double center_r;
-    double center_i;
-    double zoom;
-} ThreadArgs;
+    int head;
+    int queued;
+    int finished;           // The producer will queue no more frames
+    int closed;             // The consumer takes no more frames
+    pthread_mutex_t lock;
+    pthread_cond_t frame_queued;
+    pthread_cond_t slot_free;
+} FrameQueue;
+
+/**
+ * @brief Allocates `num_slots` (at most FRAME_QUEUE_MAX) width x height buffers.
+ * @return 0 on success, -1 if out of memory.
+ */
+static int frame_queue_init(FrameQueue* queue, int num_slots, int width, int height) {
+    *queue = (FrameQueue){ .num_slots = num_slots, .pitch = width * 4 };
+    for (int i = 0; i < num_slots; i++) {
+        queue->slots[i].pixels = malloc((size_t)queue->pitch * height);
+        if (!queue->slots[i].pixels) {
+            for (int j = 0; j < i; j++) free(queue->slots[j].pixels);
+            return -1;
+        }
+    }
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->frame_queued, NULL);
+    pthread_cond_init(&queue->slot_free, NULL);
+    return 0;
+}
+
+static void frame_queue_free(FrameQueue* queue) {
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->frame_queued);
+    pthread_cond_destroy(&queue->slot_free);
+    for (int i = 0; i < queue->num_slots; i++) {
+        free(queue->slots[i].pixels);
+        free(queue->slots[i].workers);
+    }
+}
+
+/**
+ * @brief Producer: waits for a free buffer to render the next frame into.
+ * @return The slot, or NULL once the consumer has closed the queue.
+ */
+static QueuedFrame* frame_queue_acquire(FrameQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->queued == queue->num_slots && !queue->closed) {
+        pthread_cond_wait(&queue->slot_free, &queue->lock);
+    }
+    QueuedFrame* slot = queue->closed ? NULL
+        : &queue->slots[(queue->head + queue->queued) % queue->num_slots];
+    pthread_mutex_unlock(&queue->lock);
+    return slot;
+}
+
+/**
+ * @brief Producer: hands the acquired slot, now rendered, to the consumer.
+ */
+static void frame_queue_push(FrameQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->queued++;
+    pthread_cond_signal(&queue->frame_queued);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/**
+ * @brief Producer: marks the end of the frames.
+ */
+static void frame_queue_finish(FrameQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->finished = 1;
+    pthread_cond_signal(&queue->frame_queued);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/**
+ * @brief Consumer: waits for the oldest rendered frame.
+ * @return The frame, or NULL once the producer has finished and every frame
+ * has been released.
+ */
+static QueuedFrame* frame_queue_peek(FrameQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->queued == 0 && !queue->finished) {
+        pthread_cond_wait(&queue->frame_queued, &queue->lock);
+    }
+    QueuedFrame* frame = queue->queued > 0 ? &queue->slots[queue->head] : NULL;
+    pthread_mutex_unlock(&queue->lock);
+    return frame;
+}
+
+/**
+ * @brief Consumer: releases the oldest frame's buffer to the producer.
+ */
+static void frame_queue_pop(FrameQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->head = (queue->head + 1) % queue->num_slots;
+    queue->queued--;
+    pthread_cond_signal(&queue->slot_free);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/**
+ * @brief Consumer: stops taking frames, waking a producer waiting for a slot.
+ */
+static void frame_queue_close(FrameQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->closed = 1;
+    pthread_cond_signal(&queue->slot_free);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+
+// --- Headless Rendering ---
+// Settings of a --render run
+typedef struct {
+    const char* center;     // "R,I" as given, parsed at full precision
+    double zoom;            // Zoom of the single frame, or of frame 0 with --frames
+    int width;
+    int height;
+    const char* output;     // PNG, or PPM for a ".ppm" name; see below for --frames
+    int first_frame;        // --frames A:B, or -1 for a single frame
+    int last_frame;
+    double zoom_speed;      // Zoom factor per frame of a sequence (--zoom-speed)
+} HeadlessJob;
+
+/**
+ * @brief Checks that a sequence output name holds exactly one integer
+ * conversion (e.g. "frame%05d.png") and no other '%'.
+ */
+static int is_frame_pattern(const char* s) {
+    int conversions = 0;
+    for (const char* p = strchr(s, '%'); p; p = strchr(p, '%')) {
+        p++;
+        if (*p == '0') p++;
+        while (*p >= '0' && *p <= '9') p++;
+        if (*p != 'd') return 0;
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+/**
+ * @brief Writes frame k of a sequence: packed RGB to stdout for "-", else
+ * an image file named by the frame pattern.
+ * @return 0 on success, -1 on a write error.
+ */
+static int write_sequence_frame(const HeadlessJob* job, int k, const void* pixels) {
+    int pitch = job->width * 4;
+    if (strcmp(job->output, "-") == 0) {
+        if (image_write_rgb(stdout, pixels, job->width, job->height, pitch) != 0
+            || fflush(stdout) != 0) {
+            fprintf(stderr, "Could not write frame %d to standard output.\n", k);
+            return -1;
+        }
+        return 0;
+    }
+    char path[4096];
+    snprintf(path, sizeof(path), job->output, k);
+    if (image_write(path, pixels, job->width, job->height, pitch) != 0) {
+        fprintf(stderr, "Could not write %s.\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Frames a zoom sequence renders ahead of its writer thread
+#define SEQUENCE_BUFFERS 3
+
+// A sequence and the queue carrying its frames to the writer thread
+typedef struct {
+    const HeadlessJob* job;
+    FrameQueue queue;
+} SequenceWriter;
+
+/**
+ * @brief Body of the writer thread: writes queued frames in order until the
+ * last one, closing the queue if a write fails.
+ */
+static void* sequence_writer(void* args) {
+    SequenceWriter* writer = (SequenceWriter*)args;
+    trace_attach(TRACE_PIPELINE, "writer");
+    QueuedFrame* frame;
+    while ((frame = frame_queue_peek(&writer->queue)) != NULL) {
+        Uint64 write_start = trace_clock();
+        int status = write_sequence_frame(writer->job, frame->number, frame->pixels);
+        trace_span("write", "frame", frame->number, write_start);
+        frame_queue_pop(&writer->queue);
+        if (status != 0) {
+            frame_queue_close(&writer->queue);
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Renders frames first_frame..last_frame of a zoom sequence, frame k
+ * at zoom * zoom_speed^k as in the interactive loop, while a writer thread
+ * encodes and writes earlier frames.
+ * @return 0 on success, -1 on failure.
+ */
+static int render_sequence(const HeadlessJob* job, FrameRequest* request,
+                           IterationLimit* iter_limit) {
+    SequenceWriter writer = { .job = job };
+    if (frame_queue_init(&writer.queue, SEQUENCE_BUFFERS, job->width, job->height) != 0) {
+        fprintf(stderr, "Out of memory for %d %dx%d frames.\n", SEQUENCE_BUFFERS,
+                job->width, job->height);
+        return -1;
+    }
+    for (int i = 0; i < SEQUENCE_BUFFERS; i++) {
+        renderer_place_buffer(writer.queue.slots[i].pixels, writer.queue.pitch,
+                              job->width, job->height);
+    }
+    pthread_t writer_thread;
+    if (pthread_create(&writer_thread, NULL, sequence_writer, &writer) != 0) {
+        frame_queue_free(&writer.queue);
+        return -1;
+    }
 
-// Global row counter for dynamic scheduling
-static atomic_int next_row;
+    FrameResult last_frame;
+    int have_last_frame = 0;
+    int status = 0;
+    for (int k = job->first_frame; k <= job->last_frame; k++) {
+        Uint64 acquire_start = trace_clock();
+        QueuedFrame* frame = frame_queue_acquire(&writer.queue);
+        trace_span("acquire", "frame", k, acquire_start);
+        if (!frame) {
+            status = -1;    // The writer failed
+            break;
+        }
+        request->zoom = job->zoom * pow(job->zoom_speed, k);
+        if (request->zoom < DEEPEST_ZOOM) {
+            fprintf(stderr, "Frame %d passes the deepest supported zoom (%g).\n", k, DEEPEST_ZOOM);
+            status = -1;
+            break;
+        }
+        update_iteration_limit(iter_limit, request->zoom, have_last_frame ? &last_frame.stats : NULL,
+                               have_last_frame ? last_frame.pixels_rendered : 0);
+        request->max_iterations = iter_limit->limit;
 
+        Uint64 start = SDL_GetPerformanceCounter();
+        if (renderer_render_frame(request, frame->pixels, writer.queue.pitch, &last_frame) != 0) {
+            status = -1;
+            break;
+        }
+        have_last_frame = 1;
+        Uint64 end = SDL_GetPerformanceCounter();
+        if (trace_enabled) trace_record("frame", "frame", k, start, end);
+        double ms = 1000.0 * (double)(end - start) / (double)SDL_GetPerformanceFrequency();
+        // Standard output may be carrying the frames, so report on stderr
+        fprintf(stderr, "Frame %d: zoom %g, %d iterations max, %.1f ms\n", k, request->zoom,
+                request->max_iterations, ms);
+
+        frame->number = k;
+        frame->request = *request;
+        frame_queue_push(&writer.queue);
+    }
+
+    frame_queue_finish(&writer.queue);
+    pthread_join(writer_thread, NULL);
+    if (writer.queue.closed) status = -1;
+    frame_queue_free(&writer.queue);
+    return status;
+}
 
-// --- Mandelbrot Calculation ---
 /**
- * @brief Maps an iteration count to a color.
+ * @brief Renders a single frame and writes it to job->output.
+ * @return 0 on success, -1 on failure.
  */
-Color get_color(int n) {
-    Color color;
-    if (n >= MAX_ITERATIONS) {
-        color.r = 0; color.g = 0; color.b = 0; // Black for points inside the set
-    } else {
-        // Psychedelic coloring
-        color.r = (int)(sin(0.1 * n) * 127 + 128);
-        color.g = (int)(sin(0.1 * n + 2) * 127 + 128);
-        color.b = (int)(sin(0.1 * n + 4) * 127 + 128);
-    }
-    return color;
+static int render_single(const HeadlessJob* job, FrameRequest* request,
+                         IterationLimit* iter_limit) {
+    int pitch = job->width * 4;
+    void* pixels = malloc((size_t)pitch * job->height);
+    if (!pixels) {
+        fprintf(stderr, "Out of memory for a %dx%d image.\n", job->width, job->height);
+        return -1;
+    }
+    renderer_place_buffer(pixels, pitch, job->width, job->height);
+    request->zoom = job->zoom;
+    update_iteration_limit(iter_limit, job->zoom, NULL, 0);
+    request->max_iterations = iter_limit->limit;
+
+    FrameResult result;
+    Uint64 start = SDL_GetPerformanceCounter();
+    int status = renderer_render_frame(request, pixels, pitch, &result);
+    double ms = 1000.0 * (double)(SDL_GetPerformanceCounter() - start)
+        / (double)SDL_GetPerformanceFrequency();
+    if (status == 0) {
+        printf("Rendered %dx%d at zoom %g, %d iterations max, in %.1f ms.\n",
+               job->width, job->height, job->zoom, request->max_iterations, ms);
+        status = image_write(job->output, pixels, job->width, job->height, pitch);
+        if (status != 0) fprintf(stderr, "Could not write %s.\n", job->output);
+    }
+    free(pixels);
+    return status;
 }
 
 /**
- * @brief Checks if a point is within the main cardioid or period-2 bulb.
- * This is a major optimization, allowing us to skip the main loop for many pixels.
- * @return 1 if the point is in a checked region (and thus in the set), 0 otherwise.
+ * @brief Runs --render: one frame, or a zoom sequence with --frames, on the
+ * worker pool, without initialising SDL video or opening a window.
+ * @return Process exit status.
  */
-int periodicity_check(double cr, double ci) {
-    // Check for period-2 bulb
-    if ((cr + 1.0) * (cr + 1.0) + ci * ci < 0.0625) { // 1/16
+static int render_headless(HeadlessJob* job, const RendererConfig* config,
+                           IterationLimit* iter_limit) {
+    FrameRequest request = { .width = job->width, .height = job->height };
+    const char* end = hp_from_string(&request.center_r, job->center);
+    end = end && *end == ',' ? hp_from_string(&request.center_i, end + 1) : NULL;
+    if (!end || *end != '\0') {
+        fprintf(stderr, "Center must be given as R,I (e.g. -0.743643887,0.131825904).\n");
         return 1;
     }
-    // Check for main cardioid
-    double q = (cr - 0.25) * (cr - 0.25) + ci * ci;
-    if (q * (q + (cr - 0.25)) < 0.25 * ci * ci) {
+    int sequence = job->first_frame >= 0;
+    if (!job->output) job->output = sequence ? "frame%05d.png" : "fractal.png";
+    if (sequence && strcmp(job->output, "-") != 0 && !is_frame_pattern(job->output)) {
+        fprintf(stderr, "With --frames, -o takes '-' or a name with one %%d (e.g. frame%%05d.png).\n");
         return 1;
     }
-    return 0;
+#ifdef _WIN32
+    if (sequence && strcmp(job->output, "-") == 0) _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    RendererConfig frame_config = *config;
+    frame_config.max_width = job->width;
+    frame_config.max_height = job->height;
+    if (renderer_init(&frame_config) < 1) {
+        fprintf(stderr, "Could not start the renderer.\n");
+        return 1;
+    }
+    int status = sequence ? render_sequence(job, &request, iter_limit)
+                          : render_single(job, &request, iter_limit);
+    renderer_shutdown();
+    return status == 0 ? 0 : 1;
 }
 
 
+// --- Benchmark Suite ---
+// --bench renders each of benchmark_views (see renderer.h) at its own size.
+
+// A view's timing is stable once BENCH_WINDOW consecutive frames are within
+// BENCH_SPREAD of each other; a view gives up after BENCH_MAX_FRAMES frames
+// or BENCH_MAX_SECONDS.
+#define BENCH_WINDOW      3
+#define BENCH_SPREAD      0.02
+#define BENCH_MAX_FRAMES  30
+#define BENCH_MAX_SECONDS 20.0
+
 /**
- * @brief The function executed by each thread.
- * It renders rows pulled from a shared counter to improve load balancing.
+ * @brief Renders `view` until its frame time is stable and prints its JSON
+ * object: throughput over the stable window and each worker's busy time.
+ * @return 0 on success, -1 if a frame failed.
  */
-void* render_thread(void* args) {
-    ThreadArgs* thread_args = (ThreadArgs*)args;
-
-    // Get parameters from the args struct
-    void* pixels = thread_args->pixels;
-    int pitch = thread_args->pitch;
-    double center_r = thread_args->center_r;
-    double center_i = thread_args->center_i;
-    double zoom = thread_args->zoom;
-
-    double aspect_ratio = (double)SCREEN_WIDTH / (double)SCREEN_HEIGHT;
-    double x_scale = (4.0 * aspect_ratio * zoom) / SCREEN_WIDTH;
-    double y_scale = (4.0 * zoom) / SCREEN_WIDTH;
-
-// --- MODIFIED: Use SSE2 optimized path for x86, standard C path for ARM/others ---
-#if defined(__x86_64__) || defined(__i386__)
-    // --- SSE2 (x86/x64) Optimized Path ---
-
-    // SSE2 constants
-    const __m128d _fours = _mm_set1_pd(4.0);
-    const __m128d _ones = _mm_set1_pd(1.0);
-    const __m128d _two = _mm_set1_pd(2.0);
-
-    while (1) {
-        int y = atomic_fetch_add(&next_row, 1);
-        if (y >= SCREEN_HEIGHT) break;
-        Uint32* row = (Uint32*)((Uint8*)pixels + y * pitch);
-        double ci_base = center_i + (y - SCREEN_HEIGHT / 2.0) * y_scale;
-
-        for (int x = 0; x < SCREEN_WIDTH; x += 2) {
-            double cr_base0 = center_r + (x - SCREEN_WIDTH / 2.0) * x_scale;
-            double cr_base1 = center_r + (x + 1 - SCREEN_WIDTH / 2.0) * x_scale;
-            
-            // --- Periodicity Check ---
-            // If both pixels are in a known black area, we can skip them entirely.
-            if (periodicity_check(cr_base0, ci_base) && periodicity_check(cr_base1, ci_base)) {
-                row[x] = 0xFF000000;
-                if(x + 1 < SCREEN_WIDTH) row[x+1] = 0xFF000000;
-                continue;
-            }
+static int benchmark_view(const BenchmarkView* view, int num_threads, const char* separator) {
+    FrameRequest request = { .zoom = view->zoom, .width = view->width, .height = view->height,
+                             .max_iterations = view->max_iterations };
+    const char* end = hp_from_string(&request.center_r, view->center);
+    hp_from_string(&request.center_i, end + 1);
+    void* pixels = malloc((size_t)view->width * 4 * view->height);
+    double* busy_ms = (double*)calloc((size_t)BENCH_WINDOW * num_threads, sizeof(double));
+    if (!pixels || !busy_ms) {
+        free(pixels);
+        free(busy_ms);
+        return -1;
+    }
+    renderer_place_buffer(pixels, view->width * 4, view->width, view->height);
 
-            // --- SIMD Calculation ---
-            __m128d _cr = _mm_set_pd(cr_base1, cr_base0);
-            __m128d _ci = _mm_set1_pd(ci_base);
-            
-            __m128d _zr = _mm_setzero_pd();
-            __m128d _zi = _mm_setzero_pd();
-            
-            __m128d _iterations = _mm_setzero_pd();
-            
-            for (int i = 0; i < MAX_ITERATIONS; i++) {
-                __m128d _zr2 = _mm_mul_pd(_zr, _zr);
-                __m128d _zi2 = _mm_mul_pd(_zi, _zi);
-                
-                // Check if the points have escaped
-                __m128d _mag2 = _mm_add_pd(_zr2, _zi2);
-                __m128d _escape_mask = _mm_cmplt_pd(_mag2, _fours);
-                
-                // If all points have escaped, we can break early
-                if (_mm_movemask_pd(_escape_mask) == 0) break;
-                
-                // Add 1 to iteration count for points that have not escaped
-                _iterations = _mm_add_pd(_iterations, _mm_and_pd(_escape_mask, _ones));
-                
-                // Calculate next Mandelbrot iteration: z = z^2 + c
-                __m128d _zri = _mm_mul_pd(_zr, _zi);
-                __m128d _zr_temp = _mm_add_pd(_mm_sub_pd(_zr2, _zi2), _cr);
-                _zi = _mm_add_pd(_mm_mul_pd(_zri, _two), _ci);
-                _zr = _zr_temp;
-            }
-            
-            // --- Unpack results and color pixels ---
-            double n_values[2];
-            _mm_storeu_pd(n_values, _iterations);
-            
-            Color color1 = get_color((int)n_values[0]);
-            row[x] = (0xFF << 24) | (color1.r << 16) | (color1.g << 8) | color1.b;
-            
-            if (x + 1 < SCREEN_WIDTH) {
-                Color color2 = get_color((int)n_values[1]);
-                row[x+1] = (0xFF << 24) | (color2.r << 16) | (color2.g << 8) | color2.b;
+    // One untimed frame computes the reference orbit and faults in the buffers
+    FrameResult result;
+    int status = renderer_render_frame(&request, pixels, view->width * 4, &result);
+
+    const double frequency = (double)SDL_GetPerformanceFrequency();
+    double frame_ms[BENCH_WINDOW];
+    double elapsed_ms = 0.0;
+    int frames = 0, stable = 0;
+    while (status == 0 && !stable && frames < BENCH_MAX_FRAMES
+           && elapsed_ms < BENCH_MAX_SECONDS * 1000.0) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        status = renderer_render_frame(&request, pixels, view->width * 4, &result);
+        Uint64 end = SDL_GetPerformanceCounter();
+        if (trace_enabled) trace_record(view->name, "frame", frames, start, end);
+        double ms = 1000.0 * (double)(end - start) / frequency;
+        int slot = frames % BENCH_WINDOW;
+        frame_ms[slot] = ms;
+        for (int t = 0; t < num_threads && t < result.num_workers; t++) {
+            busy_ms[slot * num_threads + t] = result.workers[t].busy_ms;
+        }
+        elapsed_ms += ms;
+        frames++;
+
+        if (frames >= BENCH_WINDOW) {
+            double fastest = frame_ms[0], slowest = frame_ms[0];
+            for (int i = 1; i < BENCH_WINDOW; i++) {
+                if (frame_ms[i] < fastest) fastest = frame_ms[i];
+                if (frame_ms[i] > slowest) slowest = frame_ms[i];
             }
+            stable = slowest - fastest <= BENCH_SPREAD * fastest;
+        }
+    }
+    if (status != 0) {
+        free(pixels);
+        free(busy_ms);
+        return -1;
+    }
+
+    // Averages over the last BENCH_WINDOW frames
+    int window = frames < BENCH_WINDOW ? frames : BENCH_WINDOW;
+    double mean_ms = 0.0;
+    for (int i = 0; i < window; i++) mean_ms += frame_ms[i] / window;
+    double pixels_per_frame = (double)view->width * view->height;
+    fprintf(stderr, "%-10s %9.2f ms/frame over %d frames%s\n", view->name, mean_ms, frames,
+            stable ? "" : " (not stable)");
+
+    printf("%s    {\n", separator);
+    printf("      \"name\": \"%s\",\n", view->name);
+    printf("      \"center\": \"%s\",\n", view->center);
+    printf("      \"zoom\": %g,\n", view->zoom);
+    printf("      \"width\": %d,\n", view->width);
+    printf("      \"height\": %d,\n", view->height);
+    printf("      \"max_iterations\": %d,\n", view->max_iterations);
+    printf("      \"kernel\": \"%s\",\n", result.kernel);
+    printf("      \"precision\": \"%s\",\n", result.precision);
+    printf("      \"frames\": %d,\n", frames);
+    printf("      \"stable\": %s,\n", stable ? "true" : "false");
+    printf("      \"frame_ms\": %.3f,\n", mean_ms);
+    printf("      \"mpixels_per_s\": %.3f,\n", pixels_per_frame / mean_ms / 1e3);
+    printf("      \"giterations_per_s\": %.3f,\n", (double)result.stats.iterations / mean_ms / 1e6);
+    printf("      \"lane_utilisation\": %.4f,\n", result.stats.lane_slots
+           ? (double)result.stats.iterations / (double)result.stats.lane_slots : 1.0);
+    printf("      \"thread_busy_ms\": [");
+    for (int t = 0; t < num_threads; t++) {
+        double mean_busy = 0.0;
+        for (int i = 0; i < window; i++) mean_busy += busy_ms[i * num_threads + t] / window;
+        printf("%s%.3f", t ? ", " : "", mean_busy);
+    }
+    printf("]\n    }");
+
+    free(pixels);
+    free(busy_ms);
+    return 0;
+}
+
+/**
+ * @brief Runs --bench: renders every suite view on the worker pool and prints
+ * the results as JSON on stdout, with progress on stderr.
+ * @return Process exit status.
+ */
+static int run_benchmark_suite(const RendererConfig* config) {
+    RendererConfig bench_config = *config;
+    for (int v = 0; v < num_benchmark_views; v++) {
+        if (benchmark_views[v].width > bench_config.max_width) {
+            bench_config.max_width = benchmark_views[v].width;
         }
+        if (benchmark_views[v].height > bench_config.max_height) {
+            bench_config.max_height = benchmark_views[v].height;
+        }
+    }
+    int num_threads = renderer_init(&bench_config);
+    if (num_threads < 1) {
+        fprintf(stderr, "Could not start the renderer.\n");
+        return 1;
+    }
+
+    printf("{\n");
+    printf("  \"threads\": %d,\n", num_threads);
+    printf("  \"workers\": \"%s\",\n", config->spawn_per_frame ? "spawn per frame" : "persistent pool");
+    printf("  \"tile_size\": %d,\n", config->tile_size);
+    printf("  \"smooth\": %s,\n", use_smooth_coloring ? "true" : "false");
+    printf("  \"mariani_silver\": %s,\n", use_mariani_silver ? "true" : "false");
+    printf("  \"progressive\": %s,\n", use_progressive ? "true" : "false");
+    printf("  \"views\": [\n");
+    int status = 0;
+    for (int v = 0; v < num_benchmark_views && status == 0; v++) {
+        status = benchmark_view(&benchmark_views[v], num_threads, v ? ",\n" : "");
     }
+    printf("\n  ]\n}\n");
+    renderer_shutdown();
+    if (status != 0) fprintf(stderr, "A benchmark frame could not be rendered.\n");
+    return status == 0 ? 0 : 1;
+}
 
-#else
-    // --- Standard C (ARM / Fallback) Path ---
+// --numa-bench renders the first PLACEMENT_VIEWS benchmark views, the
+// shallow ones, at this size, first with floating workers, then pinned
+#define PLACEMENT_WIDTH  7680
+#define PLACEMENT_HEIGHT 4320
+#define PLACEMENT_VIEWS  2
+#define PLACEMENT_FRAMES 5
 
-    while (1) {
-        int y = atomic_fetch_add(&next_row, 1);
-        if (y >= SCREEN_HEIGHT) break;
-        Uint32* row = (Uint32*)((Uint8*)pixels + y * pitch);
-        for (int x = 0; x < SCREEN_WIDTH; x++) {
-            // Map pixel to complex plane
-            double cr = center_r + (x - SCREEN_WIDTH / 2.0) * x_scale;
-            double ci = center_i + (y - SCREEN_HEIGHT / 2.0) * y_scale;
+/**
+ * @brief Runs --numa-bench: renders large offline frames with workers left
+ * to the scheduler, then with workers pinned per NUMA node and the frame
+ * buffers first-touched by them, and prints the best throughput of each.
+ * @return Process exit status.
+ */
+static int run_placement_benchmark(const RendererConfig* config) {
+    int num_nodes = topology_init();
+    printf("NUMA nodes: %d (CPUs:", num_nodes);
+    for (int n = 0; n < num_nodes; n++) printf(" %d", topology_node_cpus(n));
+    printf("), frames of %dx%d\n", PLACEMENT_WIDTH, PLACEMENT_HEIGHT);
 
-            // Check if the point is in a known black region
-            if (periodicity_check(cr, ci)) {
-                row[x] = 0xFF000000;
-                continue;
-            }
+    const double frequency = (double)SDL_GetPerformanceFrequency();
+    const int pitch = PLACEMENT_WIDTH * 4;
+    double mpixels[2][PLACEMENT_VIEWS];
+    for (int pinned = 0; pinned < 2; pinned++) {
+        RendererConfig placement_config = *config;
+        placement_config.pin_workers = pinned;
+        placement_config.max_width = PLACEMENT_WIDTH;
+        placement_config.max_height = PLACEMENT_HEIGHT;
+        if (renderer_init(&placement_config) < 1) {
+            fprintf(stderr, "Could not start the renderer.\n");
+            return 1;
+        }
+        // A new buffer each time. The floating baseline zeroes it here, as a
+        // program unaware of NUMA would, which puts every page on the main
+        // thread's node; the pinned run has each worker touch its own band.
+        void* pixels = malloc((size_t)pitch * PLACEMENT_HEIGHT);
+        if (!pixels) {
+            fprintf(stderr, "Out of memory for a %dx%d image.\n", PLACEMENT_WIDTH, PLACEMENT_HEIGHT);
+            renderer_shutdown();
+            return 1;
+        }
+        if (pinned) {
+            renderer_place_buffer(pixels, pitch, PLACEMENT_WIDTH, PLACEMENT_HEIGHT);
+        } else {
+            memset(pixels, 0, (size_t)pitch * PLACEMENT_HEIGHT);
+        }
+
+        for (int v = 0; v < PLACEMENT_VIEWS; v++) {
+            const BenchmarkView* view = &benchmark_views[v];
+            FrameRequest request = { .zoom = view->zoom, .width = PLACEMENT_WIDTH,
+                                     .height = PLACEMENT_HEIGHT,
+                                     .max_iterations = view->max_iterations };
+            const char* end = hp_from_string(&request.center_r, view->center);
+            hp_from_string(&request.center_i, end + 1);
 
-            double zr = 0.0, zi = 0.0;
-            int n = 0;
-            for (; n < MAX_ITERATIONS; n++) {
-                double zr2 = zr * zr;
-                double zi2 = zi * zi;
-                if (zr2 + zi2 >= 4.0) {
-                    break;
+            // Best of PLACEMENT_FRAMES after an untimed warm-up frame
+            FrameResult result;
+            double best_ms = 0.0;
+            for (int f = 0; f <= PLACEMENT_FRAMES; f++) {
+                Uint64 start = SDL_GetPerformanceCounter();
+                if (renderer_render_frame(&request, pixels, pitch, &result) != 0) {
+                    free(pixels);
+                    renderer_shutdown();
+                    return 1;
                 }
-                zi = 2.0 * zr * zi + ci;
-                zr = zr2 - zi2 + cr;
+                double ms = 1000.0 * (double)(SDL_GetPerformanceCounter() - start) / frequency;
+                if (f == 1 || (f > 1 && ms < best_ms)) best_ms = ms;
             }
+            mpixels[pinned][v] = (double)PLACEMENT_WIDTH * PLACEMENT_HEIGHT / best_ms / 1e3;
+            printf("%-8s %-8s %8.1f ms/frame, %8.2f Mpixels/s\n", view->name,
+                   pinned ? "pinned" : "floating", best_ms, mpixels[pinned][v]);
+        }
+        free(pixels);
+        renderer_shutdown();
+    }
+    for (int v = 0; v < PLACEMENT_VIEWS; v++) {
+        printf("%-8s pinned vs floating: %+.1f%% throughput\n", benchmark_views[v].name,
+               100.0 * (mpixels[1][v] / mpixels[0][v] - 1.0));
+    }
+    return 0;
+}
+
+
+// --- Frame Statistics ---
+// Main-loop phases of each presented frame
+enum { PHASE_POLL, PHASE_WAIT, PHASE_UPLOAD, PHASE_PRESENT, NUM_PHASES };
+static const char* const phase_names[NUM_PHASES] = { "poll", "wait", "upload", "present" };
 
-            Color color = get_color(n);
-            row[x] = (0xFF << 24) | (color.r << 16) | (color.g << 8) | color.b;
+#define STATS_REPORT_INTERVAL 120   // Frames per rolling summary
+
+// Per-frame instrumentation of the viewer (--stats, --stats-csv), kept by the
+// main thread. The render thread leaves each frame's worker counters and
+// render-side times in its queue slot; the main thread adds the times of its
+// own phases. Previews are counted towards the frame they refine. With both
+// outputs off, nothing is timed or copied.
+typedef struct {
+    int enabled;
+    int summary;                // Rolling summary on stderr
+    FILE* csv;                  // A row per frame, or NULL
+    int num_workers;
+
+    // Frame being shown
+    QueuedFrame frame;          // Copy of the slot, with its own worker counters
+    int previews;
+    double phase_ms[NUM_PHASES];
+
+    // Totals since the last summary
+    int frames;
+    double acquire_ms, render_ms;
+    double total_phase_ms[NUM_PHASES];
+    double max_busy_ms;         // Sum over frames of the busiest worker's time
+    WorkerStats* totals;        // Per worker
+} ViewerStats;
+
+/**
+ * @brief Allocates the counters for `num_workers` workers and, with a CSV
+ * file, writes its header.
+ * @return 0 on success, -1 if out of memory.
+ */
+static int viewer_stats_init(ViewerStats* stats, int num_workers) {
+    stats->enabled = stats->summary || stats->csv;
+    stats->num_workers = num_workers;
+    if (!stats->enabled) return 0;
+    stats->frame.workers = (WorkerStats*)calloc(num_workers, sizeof(WorkerStats));
+    stats->totals = (WorkerStats*)calloc(num_workers, sizeof(WorkerStats));
+    if (!stats->frame.workers || !stats->totals) return -1;
+    if (stats->csv) {
+        fprintf(stats->csv, "frame,width,height,max_iterations,previews,acquire_ms,render_ms");
+        for (int p = 0; p < NUM_PHASES; p++) fprintf(stats->csv, ",%s_ms", phase_names[p]);
+        fprintf(stats->csv, ",max_busy_ms,mean_busy_ms");
+        for (int w = 0; w < num_workers; w++) {
+            fprintf(stats->csv, ",w%d_tiles,w%d_iterations,w%d_busy_ms,w%d_idle_ms", w, w, w, w);
         }
+        fprintf(stats->csv, "\n");
     }
+    return 0;
+}
 
-#endif
+static void viewer_stats_free(ViewerStats* stats) {
+    if (stats->csv) fclose(stats->csv);
+    free(stats->frame.workers);
+    free(stats->totals);
+}
+
+/**
+ * @brief Reads the performance counter when statistics or tracing are on, so
+ * the main loop's phase boundaries cost nothing otherwise.
+ */
+static inline Uint64 viewer_stats_clock(const ViewerStats* stats) {
+    return stats->enabled || trace_enabled ? SDL_GetPerformanceCounter() : 0;
+}
+
+/**
+ * @brief Takes the render-side record of `frame` before its buffer is released.
+ */
+static void viewer_stats_take(ViewerStats* stats, const QueuedFrame* frame) {
+    if (!stats->enabled) return;
+    if (!frame->complete) {
+        stats->previews++;
+        return;
+    }
+    WorkerStats* workers = stats->frame.workers;
+    stats->frame = *frame;
+    stats->frame.workers = workers;
+    memcpy(workers, frame->workers, stats->num_workers * sizeof(WorkerStats));
+}
+
+/**
+ * @brief Prints the averages since the last summary: phase times per frame,
+ * then each worker's share of the work and its idle time at the join.
+ */
+static void viewer_stats_report(const ViewerStats* stats) {
+    const int n = stats->frames;
+    fprintf(stderr, "Frame phases over %d frames (ms/frame): acquire %.2f, render %.2f", n,
+            stats->acquire_ms / n, stats->render_ms / n);
+    for (int p = 0; p < NUM_PHASES; p++) {
+        fprintf(stderr, ", %s %.2f", phase_names[p], stats->total_phase_ms[p] / n);
+    }
+    double busy_ms = 0.0;
+    for (int w = 0; w < stats->num_workers; w++) busy_ms += stats->totals[w].busy_ms;
+    double mean_busy_ms = busy_ms / stats->num_workers / n;
+    fprintf(stderr, "\nWorkers: busiest %.2f ms/frame, mean %.2f (%.0f%% imbalance)\n",
+            stats->max_busy_ms / n, mean_busy_ms,
+            mean_busy_ms > 0.0 ? 100.0 * (stats->max_busy_ms / n / mean_busy_ms - 1.0) : 0.0);
+    for (int w = 0; w < stats->num_workers; w++) {
+        const WorkerStats* total = &stats->totals[w];
+        fprintf(stderr, "  worker %2d: %6.1f tiles, %9.3g iterations, %7.2f ms busy, %7.2f ms idle\n",
+                w, (double)total->tiles / n, (double)total->iterations / n, total->busy_ms / n,
+                total->idle_ms / n);
+    }
+}
+
+/**
+ * @brief Adds the main-loop phases of one presented frame, bounded by the
+ * clock readings `marks[0..NUM_PHASES]`. After the last buffer of a
+ * complete frame, records the frame.
+ */
+static void viewer_stats_present(ViewerStats* stats, const Uint64* marks, int complete) {
+    if (!stats->enabled) return;
+    const double frequency = (double)SDL_GetPerformanceFrequency();
+    for (int p = 0; p < NUM_PHASES; p++) {
+        stats->phase_ms[p] += 1000.0 * (double)(marks[p + 1] - marks[p]) / frequency;
+    }
+    if (!complete) return;
+
+    const QueuedFrame* frame = &stats->frame;
+    double max_busy_ms = 0.0, busy_ms = 0.0;
+    for (int w = 0; w < stats->num_workers; w++) {
+        const WorkerStats* worker = &frame->workers[w];
+        if (worker->busy_ms > max_busy_ms) max_busy_ms = worker->busy_ms;
+        busy_ms += worker->busy_ms;
+        stats->totals[w].tiles += worker->tiles;
+        stats->totals[w].iterations += worker->iterations;
+        stats->totals[w].busy_ms += worker->busy_ms;
+        stats->totals[w].idle_ms += worker->idle_ms;
+    }
+    if (stats->csv) {
+        fprintf(stats->csv, "%d,%d,%d,%d,%d,%.3f,%.3f", frame->number, frame->request.width,
+                frame->request.height, frame->request.max_iterations, stats->previews,
+                frame->acquire_ms, frame->render_ms);
+        for (int p = 0; p < NUM_PHASES; p++) fprintf(stats->csv, ",%.3f", stats->phase_ms[p]);
+        fprintf(stats->csv, ",%.3f,%.3f", max_busy_ms, busy_ms / stats->num_workers);
+        for (int w = 0; w < stats->num_workers; w++) {
+            const WorkerStats* worker = &frame->workers[w];
+            fprintf(stats->csv, ",%d,%llu,%.3f,%.3f", worker->tiles,
+                    (unsigned long long)worker->iterations, worker->busy_ms, worker->idle_ms);
+        }
+        fprintf(stats->csv, "\n");
+    }
+
+    stats->frames++;
+    stats->acquire_ms += frame->acquire_ms;
+    stats->render_ms += frame->render_ms;
+    stats->max_busy_ms += max_busy_ms;
+    for (int p = 0; p < NUM_PHASES; p++) stats->total_phase_ms[p] += stats->phase_ms[p];
+    memset(stats->phase_ms, 0, sizeof(stats->phase_ms));
+    stats->previews = 0;
+    if (stats->frames == STATS_REPORT_INTERVAL) {
+        if (stats->summary) viewer_stats_report(stats);
+        stats->frames = 0;
+        stats->acquire_ms = stats->render_ms = stats->max_busy_ms = 0.0;
+        memset(stats->total_phase_ms, 0, sizeof(stats->total_phase_ms));
+        memset(stats->totals, 0, stats->num_workers * sizeof(WorkerStats));
+    }
+}
+
+
+// --- Viewer Pipeline ---
+// Frame buffers of the viewer: one being rendered while the previous frame
+// waits for, or is in, upload and present
+#define VIEWER_BUFFERS 2
+
+// With --progressive, frames after a click, and frames following one that
+// took longer than this, show each coarse pass as it completes
+#define PREVIEW_MS 20.0
+
+// The interactive viewer's frame pipeline. A render thread produces frames
+// into CPU-side buffers while the main thread, which owns all SDL video
+// calls, uploads and presents earlier ones, so the workers keep rendering
+// while present waits for vsync.
+typedef struct {
+    FrameQueue queue;
+    const RendererConfig* config;
+    IterationLimit* iter_limit;
+    ResolutionScaler* res_scaler;
+    pthread_mutex_t target_lock;    // Guards the three fields below
+    HPFixed target_r;               // Center set by a click, taken by the next frame
+    HPFixed target_i;
+    int target_changed;
+} Viewer;
+
+/**
+ * @brief Body of the viewer's render thread: zooms in one step per frame and
+ * renders each frame into a free queue buffer, until the main thread closes
+ * the queue.
+ */
+static void* viewer_render_thread(void* args) {
+    Viewer* viewer = (Viewer*)args;
+    IterationLimit* iter_limit = viewer->iter_limit;
+    ResolutionScaler* res_scaler = viewer->res_scaler;
+
+    // Frame-time accounting: average render time and delivered frame rate are
+    // reported every FRAME_REPORT_INTERVAL frames so the pool and spawn paths
+    // can be compared.
+    const int FRAME_REPORT_INTERVAL = 120;
+    Uint64 render_ticks = 0;
+    Uint64 report_start = SDL_GetPerformanceCounter();
+    int frames_timed = 0;
+    KernelStats report_stats = { 0 };
+    FrameResult last_frame;
+    int have_last_frame = 0;
+    double last_frame_ms = 0.0;
+
+    // Frame k since the last restart is at zoom ZOOM_SPEED^k, as frame k of
+    // a --render --frames sequence
+    int zoom_step = 0;
+    FrameRequest request = { .zoom = 1.0 };
+    hp_from_double(&request.center_r, -0.743643887037151);
+    hp_from_double(&request.center_i, 0.131825904205330);
+
+    trace_attach(TRACE_PIPELINE, "render");
+    const double frequency = (double)SDL_GetPerformanceFrequency();
+    Uint64 acquire_start = SDL_GetPerformanceCounter();
+    int frame_number = 0;
+    QueuedFrame* frame;
+    while ((frame = frame_queue_acquire(&viewer->queue)) != NULL) {
+        Uint64 acquire_end = SDL_GetPerformanceCounter();
+        Uint64 acquire_ticks = acquire_end - acquire_start;
+        if (trace_enabled) trace_record("acquire", "frame", frame_number, acquire_start, acquire_end);
+        pthread_mutex_lock(&viewer->target_lock);
+        int moved = viewer->target_changed;
+        if (moved) {
+            request.center_r = viewer->target_r;
+            request.center_i = viewer->target_i;
+            viewer->target_changed = 0;
+        }
+        pthread_mutex_unlock(&viewer->target_lock);
+
+        request.zoom = pow(ZOOM_SPEED, zoom_step++);
+        if (request.zoom < DEEPEST_ZOOM) {
+            printf("Reached the deepest supported zoom; starting over.\n");
+            request.zoom = 1.0;
+            zoom_step = 1;
+        }
+
+        // --- Drawing (Multi-threaded & SIMD) ---
+        // Render into the top-left render_w x render_h region of the buffer
+        request.width = (int)(SCREEN_WIDTH * res_scaler->scale + 0.5);
+        request.height = (int)(SCREEN_HEIGHT * res_scaler->scale + 0.5);
+        if (request.width < 1) request.width = 1;
+        if (request.height < 1) request.height = 1;
+
+        update_iteration_limit(iter_limit, request.zoom, have_last_frame ? &last_frame.stats : NULL,
+                               have_last_frame ? last_frame.pixels_rendered : 0);
+        request.max_iterations = iter_limit->limit;
+
+        Uint64 render_start = SDL_GetPerformanceCounter();
+        if (renderer_begin_frame(&request) != 0) break;
+        Uint64 frame_ticks = SDL_GetPerformanceCounter() - render_start;
+        int previews = use_progressive && (moved || last_frame_ms > PREVIEW_MS);
+        int spacing;
+        do {
+            Uint64 pass_start = SDL_GetPerformanceCounter();
+            spacing = renderer_render_pass(frame->pixels, viewer->queue.pitch, previews);
+            Uint64 pass_end = SDL_GetPerformanceCounter();
+            frame_ticks += pass_end - pass_start;
+            if (trace_enabled) trace_record("render pass", "spacing", spacing, pass_start, pass_end);
+            if (spacing > 1 && previews) {
+                // Show the coarse frame and go on refining into the next buffer
+                frame->number = frame_number;
+                frame->request = request;
+                frame->complete = 0;
+                frame_queue_push(&viewer->queue);
+                acquire_start = SDL_GetPerformanceCounter();
+                frame = frame_queue_acquire(&viewer->queue);
+                acquire_end = SDL_GetPerformanceCounter();
+                acquire_ticks += acquire_end - acquire_start;
+                if (trace_enabled) {
+                    trace_record("acquire", "frame", frame_number, acquire_start, acquire_end);
+                }
+            }
+        } while (spacing > 1 && frame);
+        renderer_end_frame(&last_frame);
+        trace_span("frame", "frame", frame_number, render_start);
+        if (!frame) break;
+        last_frame_ms = 1000.0 * (double)frame_ticks / frequency;
+        frame->number = frame_number++;
+        frame->request = request;
+        frame->complete = 1;
+        frame->acquire_ms = 1000.0 * (double)acquire_ticks / frequency;
+        frame->render_ms = last_frame_ms;
+        if (frame->workers) {
+            memcpy(frame->workers, last_frame.workers,
+                   last_frame.num_workers * sizeof(WorkerStats));
+        }
+        frame_queue_push(&viewer->queue);
+
+        render_ticks += frame_ticks;
+        if (res_scaler->target_ms > 0.0) {
+            printf("Frame: %.2f ms at scale %.2f (%dx%d)\n", last_frame_ms, res_scaler->scale,
+                   request.width, request.height);
+            update_resolution_scale(res_scaler, last_frame_ms);
+        }
+        have_last_frame = 1;
+        add_kernel_stats(&report_stats, &last_frame.stats);
+        if (++frames_timed == FRAME_REPORT_INTERVAL) {
+            Uint64 now = SDL_GetPerformanceCounter();
+            double ms = 1000.0 * (double)render_ticks / frequency / frames_timed;
+            double fps = frames_timed * frequency / (double)(now - report_start);
+            printf("Render time: %.3f ms/frame, %.1f frames/s delivered (%s)\n", ms, fps,
+                   viewer->config->spawn_per_frame ? "spawn per frame" : "persistent pool");
+            printf("Iteration limit: %d\n", iter_limit->limit);
+            if (report_stats.capped > 0) {
+                printf("Interior pixels: %.1f%% exited early via cycle detection\n",
+                       100.0 * (double)report_stats.cycle_exits / (double)report_stats.capped);
+            }
+            report_stats = (KernelStats){ 0 };
+            render_ticks = 0;
+            frames_timed = 0;
+            report_start = now;
+        }
+        acquire_start = SDL_GetPerformanceCounter();
+    }
+    frame_queue_finish(&viewer->queue);
     return NULL;
 }
 
 
 // --- Main Function ---
 int main(int argc, char* argv[]) {
+    // --- Command Line ---
+    // --spawn-threads: create/join threads every frame instead of using the
+    // persistent pool (kept for frame-time comparison).
+    // --kernel NAME: force a row kernel (see `kernels` for the names).
+    // --kernel-bench: benchmark every supported kernel on several views and exit.
+    // --bench: render a fixed suite of views and print their timings as JSON.
+    // --tile N: edge length in pixels of the square tiles workers take (default 64).
+    // --mariani-silver: fill tile regions with a uniform border instead of iterating them.
+    // --progressive: render coarse-to-fine with solid guessing, showing coarse passes.
+    // --validate-ms: compare Mariani-Silver against brute force on the reference views and exit.
+    // --max-iter N: iteration limit (the limit at zoom 1 with --adaptive-iter).
+    // --adaptive-iter: scale the limit with zoom depth and capped-pixel feedback.
+    // --iter-budget M: with --adaptive-iter, keep frames under M million iterations.
+    // --smooth: color by continuous escape value instead of the integer count.
+    // --perturb: render by perturbation at every zoom, not just past double precision.
+    // --double-double: use the double-double kernels down to 1e-28 before perturbation.
+    // --f32: render shallow views in single instead of double precision.
+    // --target-ms T: lower the render resolution when frames take longer than T ms.
+    // --reproject F: reuse the previous frame and recompute only a share F of the tiles.
+    // --stats: print frame phase times and per-worker load every 120 frames (stderr).
+    // --stats-csv FILE: write the same counters for every frame as CSV.
+    // --trace FILE: record a timeline of frames, phases and tiles as Chrome trace JSON.
+    // --pin: pin workers to NUMA nodes, each node rendering a band of the frame.
+    // --numa-bench: compare floating and pinned workers on large frames and exit.
+    // --render: render one frame to an image file and exit, without a window:
+    //   --center R,I  view center (default the auto-zoom target)
+    //   --zoom Z      1 is the opening view (default 1)
+    //   --size WxH    image size in pixels (default 1920x1080)
+    //   -o FILE       output, PNG or PPM by extension (default fractal.png)
+    //   --frames A:B  render frames A..B of a zoom sequence, frame k at zoom Z * S^k;
+    //                 -o is then a pattern such as frame%05d.png, or '-' for raw
+    //                 RGB24 frames on stdout
+    //   --zoom-speed S  zoom factor per sequence frame (default 0.985, as the viewer)
+    RendererConfig config = { .tile_size = 64 };
+    const char* kernel_name = NULL;
+    int kernel_bench = 0;
+    int bench = 0;
+    int numa_bench = 0;
+    int validate_ms = 0;
+    int headless = 0;
+    HeadlessJob job = { .center = "-0.743643887037151,0.131825904205330", .zoom = 1.0,
+                        .width = 1920, .height = 1080, .first_frame = -1,
+                        .zoom_speed = ZOOM_SPEED };
+    IterationLimit iter_limit = { .base = MAX_ITERATIONS, .feedback = 1.0 };
+    ResolutionScaler res_scaler = { .scale = 1.0 };
+    ViewerStats stats = { 0 };
+    const char* trace_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--spawn-threads") == 0) {
+            config.spawn_per_frame = 1;
+        } else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) {
+            kernel_name = argv[++i];
+        } else if (strcmp(argv[i], "--tile") == 0 && i + 1 < argc) {
+            config.tile_size = atoi(argv[++i]);
+            if (config.tile_size < 1) {
+                fprintf(stderr, "Tile size must be at least 1 pixel.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--mariani-silver") == 0) {
+            use_mariani_silver = 1;
+        } else if (strcmp(argv[i], "--progressive") == 0) {
+            use_progressive = 1;
+        } else if (strcmp(argv[i], "--validate-ms") == 0) {
+            validate_ms = 1;
+        } else if (strcmp(argv[i], "--max-iter") == 0 && i + 1 < argc) {
+            iter_limit.base = atoi(argv[++i]);
+            if (iter_limit.base < 1) {
+                fprintf(stderr, "Iteration limit must be at least 1.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--adaptive-iter") == 0) {
+            iter_limit.adaptive = 1;
+        } else if (strcmp(argv[i], "--iter-budget") == 0 && i + 1 < argc) {
+            iter_limit.budget = atof(argv[++i]) * 1e6;
+        } else if (strcmp(argv[i], "--smooth") == 0) {
+            use_smooth_coloring = 1;
+        } else if (strcmp(argv[i], "--perturb") == 0) {
+            force_perturbation = 1;
+        } else if (strcmp(argv[i], "--double-double") == 0) {
+            use_double_double = 1;
+        } else if (strcmp(argv[i], "--f32") == 0) {
+            use_single_precision = 1;
+        } else if (strcmp(argv[i], "--target-ms") == 0 && i + 1 < argc) {
+            res_scaler.target_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--reproject") == 0 && i + 1 < argc) {
+            config.reproject = atof(argv[++i]);
+            if (config.reproject <= 0.0 || config.reproject > 1.0) {
+                fprintf(stderr, "Reprojection refresh fraction must be in (0, 1].\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats.summary = 1;
+        } else if (strcmp(argv[i], "--stats-csv") == 0 && i + 1 < argc) {
+            const char* path = argv[++i];
+            if (stats.csv) fclose(stats.csv);
+            stats.csv = fopen(path, "w");
+            if (!stats.csv) {
+                fprintf(stderr, "Could not open %s for writing.\n", path);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--pin") == 0) {
+            config.pin_workers = 1;
+        } else if (strcmp(argv[i], "--numa-bench") == 0) {
+            numa_bench = 1;
+        } else if (strcmp(argv[i], "--kernel-bench") == 0) {
+            kernel_bench = 1;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            bench = 1;
+        } else if (strcmp(argv[i], "--render") == 0) {
+            headless = 1;
+        } else if (strcmp(argv[i], "--center") == 0 && i + 1 < argc) {
+            job.center = argv[++i];
+        } else if (strcmp(argv[i], "--zoom") == 0 && i + 1 < argc) {
+            job.zoom = atof(argv[++i]);
+            if (!(job.zoom > 0.0)) {
+                fprintf(stderr, "Zoom must be positive.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &job.width, &job.height) != 2
+                || job.width < 1 || job.height < 1) {
+                fprintf(stderr, "Size must be given as WxH (e.g. 1920x1080).\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            job.output = argv[++i];
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d:%d", &job.first_frame, &job.last_frame) != 2
+                || job.first_frame < 0 || job.last_frame < job.first_frame) {
+                fprintf(stderr, "Frames must be given as A:B with 0 <= A <= B.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--zoom-speed") == 0 && i + 1 < argc) {
+            job.zoom_speed = atof(argv[++i]);
+            if (!(job.zoom_speed > 0.0)) {
+                fprintf(stderr, "Zoom speed must be positive.\n");
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (select_kernel(kernel_name) != 0) {
+        fprintf(stderr, "Kernel '%s' is unknown or not supported by this CPU.\n", kernel_name);
+        return 1;
+    }
+    if (validate_ms) return validate_mariani_silver();
+    config.num_threads = SDL_GetCPUCount();
+    if (numa_bench) return run_placement_benchmark(&config);
+    if (trace_path) {
+        if (trace_open(trace_path, config.num_threads) != 0) {
+            fprintf(stderr, "Could not open %s for writing.\n", trace_path);
+            return 1;
+        }
+        trace_attach(TRACE_MAIN, "main");
+    }
+    if (bench || headless) {
+        int status = bench ? run_benchmark_suite(&config)
+                           : render_headless(&job, &config, &iter_limit);
+        if (trace_close() != 0) fprintf(stderr, "Could not write %s.\n", trace_path);
+        return status;
+    }
+    benchmark_kernels(kernel_bench);
+    if (kernel_bench) return 0;
+
     // --- Initialization ---
     if (SDL_Init(SDL_INIT_VIDEO) < 0) return 1;
 
@@ -239,21 +1216,39 @@ int main(int argc, char* argv[]) {
     if (!texture) return 1;
 
     // --- Threading Setup ---
-    int num_threads = SDL_GetCPUCount();
-    if (num_threads < 1) num_threads = 1; // Fallback for safety
-    printf("Using %d threads for rendering.\n", num_threads);
-    pthread_t* threads = (pthread_t*)malloc(num_threads * sizeof(pthread_t));
-    ThreadArgs* thread_args = (ThreadArgs*)malloc(num_threads * sizeof(ThreadArgs));
-
-    // --- Fractal Parameters ---
-    double zoom = 1.0;
-    double zoom_speed = 0.985;
-    double center_r = -0.743643887037151;
-    double center_i = 0.131825904205330;
+    config.max_width = SCREEN_WIDTH;
+    config.max_height = SCREEN_HEIGHT;
+    int num_threads = renderer_init(&config);
+    if (num_threads < 1) return 1;
+    printf("Using %d threads for rendering (%s).\n", num_threads,
+           config.spawn_per_frame ? "spawn per frame" : "persistent pool");
+
+    Viewer viewer = { .config = &config, .iter_limit = &iter_limit, .res_scaler = &res_scaler };
+    if (frame_queue_init(&viewer.queue, VIEWER_BUFFERS, SCREEN_WIDTH, SCREEN_HEIGHT) != 0) return 1;
+    for (int i = 0; i < VIEWER_BUFFERS; i++) {
+        renderer_place_buffer(viewer.queue.slots[i].pixels, viewer.queue.pitch,
+                              SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+    if (viewer_stats_init(&stats, num_threads) != 0) return 1;
+    for (int i = 0; stats.enabled && i < VIEWER_BUFFERS; i++) {
+        viewer.queue.slots[i].workers = (WorkerStats*)calloc(num_threads, sizeof(WorkerStats));
+        if (!viewer.queue.slots[i].workers) return 1;
+    }
+    pthread_mutex_init(&viewer.target_lock, NULL);
+    pthread_t render_thread;
+    if (pthread_create(&render_thread, NULL, viewer_render_thread, &viewer) != 0) return 1;
 
     // --- Main Loop ---
+    // Present frames as the render thread delivers them. A frame's buffer is
+    // released as soon as it is uploaded, so the next frame renders during
+    // SDL_RenderPresent.
+    FrameRequest shown = { .zoom = 1.0 };   // Frame on screen, for mapping clicks
+    hp_from_double(&shown.center_r, -0.743643887037151);
+    hp_from_double(&shown.center_i, 0.131825904205330);
     int is_running = 1;
     while (is_running) {
+        Uint64 marks[NUM_PHASES + 1];
+        marks[PHASE_POLL] = viewer_stats_clock(&stats);
         SDL_Event e;
         while (SDL_PollEvent(&e) != 0) {
             if (e.type == SDL_QUIT) {
@@ -264,46 +1259,56 @@ int main(int argc, char* argv[]) {
                 if (e.button.button == SDL_BUTTON_LEFT) {
                     // Convert screen coordinates to complex plane coordinates
                     double aspect_ratio = (double)SCREEN_WIDTH / (double)SCREEN_HEIGHT;
-                    double mouse_r = center_r + (e.button.x - SCREEN_WIDTH / 2.0) * (4.0 * aspect_ratio * zoom) / SCREEN_WIDTH;
-                    double mouse_i = center_i + (e.button.y - SCREEN_HEIGHT / 2.0) * (4.0 * zoom) / SCREEN_WIDTH;
+                    double offset_r = (e.button.x - SCREEN_WIDTH / 2.0) * (4.0 * aspect_ratio * shown.zoom) / SCREEN_WIDTH;
+                    double offset_i = (e.button.y - SCREEN_HEIGHT / 2.0) * (4.0 * shown.zoom) / SCREEN_WIDTH;
 
-                    // Set the new center point
-                    center_r = mouse_r;
-                    center_i = mouse_i;
+                    // Set the new center point, relative to the frame on screen
+                    HPFixed center_r = shown.center_r, center_i = shown.center_i;
+                    hp_add_double(&center_r, offset_r);
+                    hp_add_double(&center_i, offset_i);
+                    pthread_mutex_lock(&viewer.target_lock);
+                    viewer.target_r = center_r;
+                    viewer.target_i = center_i;
+                    viewer.target_changed = 1;
+                    pthread_mutex_unlock(&viewer.target_lock);
 
-                    printf("New center: (%f, %f)\n", center_r, center_i);
+                    printf("New center: (%f, %f)\n", hp_to_double(&center_r),
+                           hp_to_double(&center_i));
                 }
             }
         }
+        if (!is_running) break;
 
-        zoom *= zoom_speed;
+        marks[PHASE_WAIT] = viewer_stats_clock(&stats);
+        QueuedFrame* frame = frame_queue_peek(&viewer.queue);
+        if (!frame) break;  // The render thread stopped
+        marks[PHASE_UPLOAD] = viewer_stats_clock(&stats);
+        SDL_Rect render_rect = { 0, 0, frame->request.width, frame->request.height };
+        SDL_UpdateTexture(texture, &render_rect, frame->pixels, viewer.queue.pitch);
+        shown = frame->request;
+        int complete = frame->complete, number = frame->number;
+        viewer_stats_take(&stats, frame);
+        frame_queue_pop(&viewer.queue);
 
-        // --- Drawing (Multi-threaded & SIMD) ---
-        void* pixels;
-        int pitch;
-        SDL_LockTexture(texture, NULL, &pixels, &pitch);
-
-        // Reset shared row counter and launch threads
-        atomic_store(&next_row, 0);
-        for (int i = 0; i < num_threads; i++) {
-            thread_args[i] = (ThreadArgs){ .pixels = pixels, .pitch = pitch,
-                .center_r = center_r, .center_i = center_i, .zoom = zoom };
-            pthread_create(&threads[i], NULL, render_thread, &thread_args[i]);
-        }
-
-        // Wait for all threads to complete their work
-        for (int i = 0; i < num_threads; i++) {
-            pthread_join(threads[i], NULL);
-        }
-
-        SDL_UnlockTexture(texture);
-        SDL_RenderCopy(renderer, texture, NULL, NULL);
+        marks[PHASE_PRESENT] = viewer_stats_clock(&stats);
+        SDL_RenderCopy(renderer, texture, &render_rect, NULL);
         SDL_RenderPresent(renderer);
+        marks[NUM_PHASES] = viewer_stats_clock(&stats);
+        viewer_stats_present(&stats, marks, complete);
+        for (int p = 0; trace_enabled && p < NUM_PHASES; p++) {
+            trace_record(phase_names[p], "frame", number, marks[p], marks[p + 1]);
+        }
     }
 
+    frame_queue_close(&viewer.queue);
+    pthread_join(render_thread, NULL);
+    frame_queue_free(&viewer.queue);
+    pthread_mutex_destroy(&viewer.target_lock);
+    viewer_stats_free(&stats);
+
     // --- Cleanup ---
-    free(threads);
-    free(thread_args);
+    renderer_shutdown();
+    if (trace_close() != 0) fprintf(stderr, "Could not write %s.\n", trace_path);
     SDL_DestroyTexture(texture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -0,0 +1,861 @@
+/*
+ * mandel_simd.h - Escape-time kernel template shared by every SIMD path.
+ *
+ * This file is included once per instruction set from renderer.c. Before each
+ * inclusion the caller defines the vector type and primitive operations below;
+ * the template then expands into these RowKernels, suffixed with KERNEL_SUFFIX:
+ *
+ *   render_span_<suffix>         one group of LANES pixels at a time
+ *   render_span_refill_<suffix>  refills each escaped lane with the next pixel
+ *   render_span_x2_<suffix>      two independent vectors per loop iteration
+ *   render_span_x4_<suffix>      four independent vectors per loop iteration
+ *   render_span_perturb_<suffix> delta iteration against view->orbit, for
+ *                                zooms beyond double precision (omitted when
+ *                                KERNEL_NO_PERTURBATION is defined)
+ *   render_span_dd_<suffix>      double-double iteration for zooms just past
+ *                                double precision (omitted when
+ *                                KERNEL_NO_DOUBLE_DOUBLE is defined, which
+ *                                instruction sets without a fused V_FMADD do)
+ *
+ * All macros are #undef'd at the end so the next instruction set can define
+ * its own.
+ *
+ *   KERNEL_SUFFIX      suffix of the generated function names
+ *   KERNEL_TARGET      function attribute enabling the instruction set
+ *   LANES              number of pixels per vector
+ *   vscalar            lane type (double, or float for the ARMv7 NEON path)
+ *   vreal / vmask      vector of vscalar / result of a lane comparison
+ *   V_SET1(x)          broadcast a scalar
+ *   V_LOADU(p)         load LANES vscalars from p
+ *   V_STOREU(p, v)     store LANES vscalars to p
+ *   V_STORE_F32(p, v)  store LANES lanes converted to float to p
+ *   V_ADD, V_SUB, V_MUL, V_DIV
+ *   V_FMADD(a, b, c)   a * b + c (fused where the instruction set allows)
+ *   V_CMPLT(a, b)      lane mask of a < b
+ *   M_BITS(m)          integer bitmask with one bit per set lane
+ *   V_ADD_IF(a, m, b)  a + b in lanes where m is set, a elsewhere
+ *   V_SELECT(m, a, b)  a in lanes where m is set, b elsewhere
+ *   V_EXPONENT(x)      unbiased binary exponent of positive normal lanes
+ *   V_MANTISSA(x)      mantissa of positive normal lanes, scaled into [1, 2)
+ *
+ * Every kernel honours view->smooth: with it set, pixels escape at
+ * |z|^2 >= SMOOTH_BAILOUT and store the continuous escape value of
+ * smooth_escape_value() instead of the integer count. Every kernel also runs
+ * Brent cycle detection, so interior pixels whose orbit turns periodic stop
+ * before the iteration limit and are counted in stats->cycle_exits.
+ */
+
+#define KERNEL_CAT_(a, b) a##_##b
+#define KERNEL_CAT(a, b)  KERNEL_CAT_(a, b)
+#define KERNEL_FN(base)   KERNEL_CAT(base, KERNEL_SUFFIX)
+
+/*
+ * log2 of positive normal lanes: the exponent plus an atanh series for the
+ * mantissa, log2(m) = 2/ln2 * (t + t^3/3 + t^5/5 + t^7/7) with
+ * t = (m - 1) / (m + 1). Accurate to about 2e-5, plenty for coloring.
+ */
+static inline __attribute__((always_inline)) KERNEL_TARGET vreal KERNEL_FN(log2_approx)(vreal x) {
+    const double k = 2.0 / 0.69314718055994531;     // 2 / ln 2
+    const vreal _ones = V_SET1(1.0);
+    vreal m = V_MANTISSA(x);
+    vreal t = V_DIV(V_SUB(m, _ones), V_ADD(m, _ones));
+    vreal t2 = V_MUL(t, t);
+    vreal p = V_FMADD(t2, V_SET1((vscalar)(k / 7.0)), V_SET1((vscalar)(k / 5.0)));
+    p = V_FMADD(t2, p, V_SET1((vscalar)(k / 3.0)));
+    p = V_FMADD(t2, p, V_SET1((vscalar)k));
+    return V_FMADD(t, p, V_EXPONENT(x));
+}
+
+/*
+ * Escape values of one vector of pixels from their iteration counts: lanes
+ * at the limit become n + ITER_INSIDE = ITER_INSIDE. With `smooth`, the
+ * others get the vectorised equivalent of smooth_escape_value() from their
+ * |z|^2 at escape, `_mag2`.
+ */
+static inline __attribute__((always_inline)) KERNEL_TARGET vreal KERNEL_FN(escape_values)(
+        vreal _iterations, vreal _mag2, int max_iterations, const int smooth) {
+    vmask _capped = V_CMPLT(V_SET1((vscalar)(max_iterations - 0.5)), _iterations);
+    vreal _values = _iterations;
+    if (smooth) {
+        // Lanes that never reached the bailout (capped, cycled or still
+        // running) get a harmless |z|^2; their values are not kept
+        const vreal _bailout = V_SET1((vscalar)SMOOTH_BAILOUT);
+        _mag2 = V_SELECT(V_CMPLT(_mag2, _bailout), _bailout, _mag2);
+        vreal _loglog = KERNEL_FN(log2_approx)(KERNEL_FN(log2_approx)(_mag2));
+        _values = V_SUB(V_ADD(_iterations, V_SET1((vscalar)(1.0 + log2(SMOOTH_BAILOUT_BITS)))), _loglog);
+    }
+    return V_ADD_IF(_values, _capped, V_SET1((vscalar)ITER_INSIDE));
+}
+
+/*
+ * Writes the escape values of one full vector of pixels, converted and
+ * stored without a round trip through a scalar array. Counts are summed into
+ * `_total` for the kernel statistics.
+ * @return Bitmask of the lanes that hit the limit.
+ */
+static inline __attribute__((always_inline)) KERNEL_TARGET int KERNEL_FN(store_escape_values)(
+        float* dst, vreal _iterations, vreal _mag2, int max_iterations, vreal* _total,
+        const int smooth) {
+    V_STORE_F32(dst, KERNEL_FN(escape_values)(_iterations, _mag2, max_iterations, smooth));
+    *_total = V_ADD(*_total, _iterations);
+    return M_BITS(V_CMPLT(V_SET1((vscalar)(max_iterations - 0.5)), _iterations));
+}
+
+/*
+ * Adds the per-lane iteration totals gathered by store_escape_values().
+ */
+static inline __attribute__((always_inline)) KERNEL_TARGET void KERNEL_FN(add_total_iterations)(
+        vreal _total, KernelStats* stats) {
+    vscalar totals[LANES];
+    V_STOREU(totals, _total);
+    for (int l = 0; l < LANES; l++) stats->iterations += (Uint64)totals[l];
+}
+
+static inline __attribute__((always_inline)) KERNEL_TARGET void KERNEL_FN(render_span_impl)(
+        const FrameView* view, int y, int x0, int x1, float* row, KernelStats* stats, const int smooth) {
+    const vreal _bailout = V_SET1(smooth ? SMOOTH_BAILOUT : 4.0);
+    const vreal _ones = V_SET1(1.0);
+    const int max_iterations = view->max_iterations;
+
+    const double cycle_eps = view->x_scale * CYCLE_TOLERANCE;
+    const vreal _cycle_eps2 = V_SET1((vscalar)(cycle_eps * cycle_eps));
+
+    double ci_base = view->center_i + (y - view->height / 2.0) * view->y_scale;
+    const vreal _ci = V_SET1((vscalar)ci_base);
+    vreal _total = V_SET1(0.0);
+
+    for (int x = x0; x < x1; x += LANES) {
+        // Lanes past x1 are computed but never written back.
+        vscalar cr_lanes[LANES];
+        int all_inside = 1;
+        for (int l = 0; l < LANES; l++) {
+            double cr = view->center_r + ((x + l) * view->x_step - view->x_origin) * view->x_scale;
+            cr_lanes[l] = (vscalar)cr;
+            if (!periodicity_check(cr, ci_base)) all_inside = 0;
+        }
+
+        // --- Periodicity Check ---
+        // If every lane is in a known black area, we can skip them entirely.
+        if (all_inside) {
+            for (int l = 0; l < LANES && x + l < x1; l++) row[x + l] = ITER_INSIDE;
+            continue;
+        }
+
+        // --- SIMD Calculation ---
+        const vreal _cr = V_LOADU(cr_lanes);
+        vreal _zr = V_SET1(0.0);
+        vreal _zi = V_SET1(0.0);
+        vreal _iterations = V_SET1(0.0);
+
+        // Brent cycle detection: z is saved whenever i + 1 is a power of two,
+        // and a lane whose orbit comes back within cycle_eps of the saved
+        // value is periodic, so it is in the set and can stop iterating.
+        vreal _saved_zr = _zr;
+        vreal _saved_zi = _zi;
+        int periodic = 0;
+
+        // Smooth coloring needs |z|^2 from the iteration each lane escaped
+        // on: _mag2 follows |z|^2 until it has reached the bailout
+        vreal _mag2 = _zr;
+
+        int i = 0;
+        for (; i < max_iterations; i++) {
+            vreal _zr2 = V_MUL(_zr, _zr);
+            vreal _zi2 = V_MUL(_zi, _zi);
+
+            // Check if the points have escaped
+            vmask _escape_mask = V_CMPLT(V_ADD(_zr2, _zi2), _bailout);
+            if (smooth) _mag2 = V_SELECT(V_CMPLT(_mag2, _bailout), V_ADD(_zr2, _zi2), _mag2);
+
+            // If all points have escaped or cycled, we can break early
+            int running = M_BITS(_escape_mask) & ~periodic;
+            if (running == 0) break;
+
+            // Add 1 to iteration count for points that have not escaped
+            _iterations = V_ADD_IF(_iterations, _escape_mask, _ones);
+
+            // Calculate next Mandelbrot iteration: z = z^2 + c
+            vreal _zr_temp = V_ADD(V_SUB(_zr2, _zi2), _cr);
+            _zi = V_FMADD(V_ADD(_zr, _zr), _zi, _ci);
+            _zr = _zr_temp;
+
+            vreal _dr = V_SUB(_zr, _saved_zr);
+            vreal _di = V_SUB(_zi, _saved_zi);
+            periodic |= M_BITS(V_CMPLT(V_FMADD(_dr, _dr, V_MUL(_di, _di)), _cycle_eps2)) & running;
+            if ((i & (i + 1)) == 0) {
+                _saved_zr = _zr;
+                _saved_zi = _zi;
+            }
+        }
+
+        stats->lane_slots += (Uint64)i * LANES;
+
+        // --- Store results ---
+        if (x + LANES <= x1) {
+            int capped = KERNEL_FN(store_escape_values)(&row[x], _iterations, _mag2, max_iterations,
+                                                        &_total, smooth);
+            stats->capped += __builtin_popcount(capped | periodic);
+            stats->cycle_exits += __builtin_popcount(periodic);
+            for (int bits = periodic; bits; bits &= bits - 1) {
+                row[x + __builtin_ctz(bits)] = ITER_INSIDE;
+            }
+            continue;
+        }
+
+        // Partial group at the end of the span
+        vscalar n_values[LANES];
+        float values[LANES];
+        V_STOREU(n_values, _iterations);
+        V_STORE_F32(values, KERNEL_FN(escape_values)(_iterations, _mag2, max_iterations, smooth));
+        for (int l = 0; l < LANES && x + l < x1; l++) {
+            stats->iterations += (Uint64)n_values[l];
+            int n = (int)n_values[l];
+            if (periodic & (1 << l)) {
+                n = max_iterations;
+                stats->cycle_exits++;
+            }
+            if (n >= max_iterations) stats->capped++;
+            row[x + l] = n >= max_iterations ? ITER_INSIDE : values[l];
+        }
+    }
+    KERNEL_FN(add_total_iterations)(_total, stats);
+}
+
+static KERNEL_TARGET void KERNEL_FN(render_span)(const FrameView* view, int y, int x0, int x1,
+                                                 float* row, KernelStats* stats) {
+    if (view->smooth) KERNEL_FN(render_span_impl)(view, y, x0, x1, row, stats, 1);
+    else KERNEL_FN(render_span_impl)(view, y, x0, x1, row, stats, 0);
+}
+
+/*
+ * Interleaved variant: iterates `ways` independent vectors in one loop body.
+ * A single z = z^2 + c chain is latency-bound; several independent chains
+ * let the out-of-order core overlap their multiplies and adds. `ways` is a
+ * compile-time constant in each wrapper below, so the per-way loops unroll
+ * and the arrays stay in registers.
+ */
+static inline __attribute__((always_inline)) KERNEL_TARGET void KERNEL_FN(render_span_interleaved)(
+        const FrameView* view, int y, int x0, int x1, float* row, KernelStats* stats, const int ways,
+        const int smooth) {
+    const vreal _bailout = V_SET1(smooth ? SMOOTH_BAILOUT : 4.0);
+    const vreal _ones = V_SET1(1.0);
+    const int max_iterations = view->max_iterations;
+
+    const double cycle_eps = view->x_scale * CYCLE_TOLERANCE;
+    const vreal _cycle_eps2 = V_SET1((vscalar)(cycle_eps * cycle_eps));
+
+    double ci_base = view->center_i + (y - view->height / 2.0) * view->y_scale;
+    const vreal _ci = V_SET1((vscalar)ci_base);
+    vreal _total = V_SET1(0.0);
+
+    for (int x = x0; x < x1; x += ways * LANES) {
+        // Lanes past x1 are computed but never written back.
+        vscalar cr_lanes[4 * LANES];
+        int all_inside = 1;
+        for (int l = 0; l < ways * LANES; l++) {
+            double cr = view->center_r + ((x + l) * view->x_step - view->x_origin) * view->x_scale;
+            cr_lanes[l] = (vscalar)cr;
+            if (!periodicity_check(cr, ci_base)) all_inside = 0;
+        }
+
+        // Skip the group only when every pixel in it is known black
+        if (all_inside) {
+            for (int l = 0; l < ways * LANES && x + l < x1; l++) row[x + l] = ITER_INSIDE;
+            continue;
+        }
+
+        // Brent cycle detection per vector, as in render_span_impl()
+        vreal _cr[4], _zr[4], _zi[4], _iterations[4], _mag2[4], _saved_zr[4], _saved_zi[4];
+        int periodic[4];
+        for (int w = 0; w < ways; w++) {
+            _cr[w] = V_LOADU(&cr_lanes[w * LANES]);
+            _zr[w] = _zi[w] = _iterations[w] = _mag2[w] = V_SET1(0.0);
+            _saved_zr[w] = _saved_zi[w] = V_SET1(0.0);
+            periodic[w] = 0;
+        }
+
+        int i = 0;
+        for (; i < max_iterations; i++) {
+            int any_running = 0;
+            for (int w = 0; w < ways; w++) {
+                vreal _zr2 = V_MUL(_zr[w], _zr[w]);
+                vreal _zi2 = V_MUL(_zi[w], _zi[w]);
+                vmask _escape_mask = V_CMPLT(V_ADD(_zr2, _zi2), _bailout);
+                if (smooth) _mag2[w] = V_SELECT(V_CMPLT(_mag2[w], _bailout), V_ADD(_zr2, _zi2), _mag2[w]);
+                int running = M_BITS(_escape_mask) & ~periodic[w];
+                any_running |= running;
+                _iterations[w] = V_ADD_IF(_iterations[w], _escape_mask, _ones);
+
+                vreal _zr_temp = V_ADD(V_SUB(_zr2, _zi2), _cr[w]);
+                _zi[w] = V_FMADD(V_ADD(_zr[w], _zr[w]), _zi[w], _ci);
+                _zr[w] = _zr_temp;
+
+                vreal _dr = V_SUB(_zr[w], _saved_zr[w]);
+                vreal _di = V_SUB(_zi[w], _saved_zi[w]);
+                periodic[w] |= M_BITS(V_CMPLT(V_FMADD(_dr, _dr, V_MUL(_di, _di)), _cycle_eps2)) & running;
+            }
+            // Stop once every lane of every vector has escaped or cycled
+            if (!any_running) break;
+            if ((i & (i + 1)) == 0) {
+                for (int w = 0; w < ways; w++) {
+                    _saved_zr[w] = _zr[w];
+                    _saved_zi[w] = _zi[w];
+                }
+            }
+        }
+
+        stats->lane_slots += (Uint64)i * ways * LANES;
+
+        if (x + ways * LANES <= x1) {
+            for (int w = 0; w < ways; w++) {
+                int capped = KERNEL_FN(store_escape_values)(&row[x + w * LANES], _iterations[w],
+                                                            _mag2[w], max_iterations, &_total, smooth);
+                stats->capped += __builtin_popcount(capped | periodic[w]);
+                stats->cycle_exits += __builtin_popcount(periodic[w]);
+                for (int bits = periodic[w]; bits; bits &= bits - 1) {
+                    row[x + w * LANES + __builtin_ctz(bits)] = ITER_INSIDE;
+                }
+            }
+            continue;
+        }
+
+        // Partial group at the end of the span
+        vscalar n_values[4 * LANES];
+        float values[4 * LANES];
+        for (int w = 0; w < ways; w++) {
+            V_STOREU(&n_values[w * LANES], _iterations[w]);
+            V_STORE_F32(&values[w * LANES], KERNEL_FN(escape_values)(_iterations[w], _mag2[w],
+                                                                     max_iterations, smooth));
+        }
+        for (int l = 0; l < ways * LANES && x + l < x1; l++) {
+            stats->iterations += (Uint64)n_values[l];
+            int n = (int)n_values[l];
+            if (periodic[l / LANES] & (1 << (l % LANES))) {
+                n = max_iterations;
+                stats->cycle_exits++;
+            }
+            if (n >= max_iterations) stats->capped++;
+            row[x + l] = n >= max_iterations ? ITER_INSIDE : values[l];
+        }
+    }
+    KERNEL_FN(add_total_iterations)(_total, stats);
+}
+
+static KERNEL_TARGET void KERNEL_FN(render_span_x2)(const FrameView* view, int y, int x0, int x1,
+                                                    float* row, KernelStats* stats) {
+    if (view->smooth) KERNEL_FN(render_span_interleaved)(view, y, x0, x1, row, stats, 2, 1);
+    else KERNEL_FN(render_span_interleaved)(view, y, x0, x1, row, stats, 2, 0);
+}
+
+static KERNEL_TARGET void KERNEL_FN(render_span_x4)(const FrameView* view, int y, int x0, int x1,
+                                                    float* row, KernelStats* stats) {
+    if (view->smooth) KERNEL_FN(render_span_interleaved)(view, y, x0, x1, row, stats, 4, 1);
+    else KERNEL_FN(render_span_interleaved)(view, y, x0, x1, row, stats, 4, 0);
+}
+
+/*
+ * Writes the smooth escape values of `count` <= LANES escaped pixels queued
+ * by render_span_refill() to row[xs[l]].
+ */
+static inline __attribute__((always_inline)) KERNEL_TARGET void KERNEL_FN(store_smooth_values)(
+        float* row, const int* xs, const vscalar* n, const vscalar* mag2, int count,
+        int max_iterations) {
+    float values[LANES];
+    V_STORE_F32(values, KERNEL_FN(escape_values)(V_LOADU(n), V_LOADU(mag2), max_iterations, 1));
+    for (int l = 0; l < count; l++) row[xs[l]] = values[l];
+}
+
+/*
+ * Lane-refilling variant: instead of running a group until its slowest lane
+ * escapes, each lane pulls the next pending pixel of the span as soon as its
+ * current one finishes, so lanes only idle once the span runs dry.
+ */
+static KERNEL_TARGET void KERNEL_FN(render_span_refill)(const FrameView* view, int y, int x0, int x1,
+                                                        float* row, KernelStats* stats) {
+    const vreal _bailout = V_SET1(view->smooth ? SMOOTH_BAILOUT : 4.0);
+    const vreal _ones = V_SET1(1.0);
+    const int max_iterations = view->max_iterations;
+    const vreal _max_iterations = V_SET1((vscalar)max_iterations);
+    const double cycle_eps = view->x_scale * CYCLE_TOLERANCE;
+    const vreal _cycle_eps2 = V_SET1((vscalar)(cycle_eps * cycle_eps));
+
+    double ci_base = view->center_i + (y - view->height / 2.0) * view->y_scale;
+    const vreal _ci = V_SET1((vscalar)ci_base);
+
+    // Per-lane state, spilled to memory only when a lane is refilled. Lanes
+    // start pixels at different times, so each keeps the iteration count at
+    // which it next saves z for Brent cycle detection.
+    vscalar cr_lanes[LANES], zr_lanes[LANES], zi_lanes[LANES], n_lanes[LANES];
+    vscalar saved_zr_lanes[LANES], saved_zi_lanes[LANES], save_at_lanes[LANES];
+    int lane_x[LANES];
+    int live = 0;   // Lanes currently holding a pixel
+
+    // With smooth coloring, escaped pixels queue their count and |z|^2 here
+    // and get their values a full vector at a time, rather than paying for a
+    // vector evaluation on every pass that finishes a lane
+    int smooth_x[2 * LANES];
+    vscalar smooth_n[2 * LANES] = { 0 }, smooth_mag2[2 * LANES] = { 0 };
+    int queued = 0;
+    int periodic = 0;
+    int next_x = x0;
+
+    for (int l = 0; l < LANES; l++) {
+        double cr = 0.0;    // Idle lanes sit at c = 0 and never escape
+        lane_x[l] = take_pending_pixel(view, ci_base, &next_x, x1, row, &cr);
+        if (lane_x[l] >= 0) live |= 1 << l;
+        cr_lanes[l] = (vscalar)cr;
+        zr_lanes[l] = zi_lanes[l] = n_lanes[l] = 0;
+        saved_zr_lanes[l] = saved_zi_lanes[l] = 0;
+        save_at_lanes[l] = 1;
+    }
+    vreal _cr = V_LOADU(cr_lanes);
+    vreal _zr = V_LOADU(zr_lanes);
+    vreal _zi = V_LOADU(zi_lanes);
+    vreal _iterations = V_LOADU(n_lanes);
+    vreal _saved_zr = V_LOADU(saved_zr_lanes);
+    vreal _saved_zi = V_LOADU(saved_zi_lanes);
+    vreal _save_at = V_LOADU(save_at_lanes);
+    Uint64 passes = 0;
+
+    while (live) {
+        vreal _zr2 = V_MUL(_zr, _zr);
+        vreal _zi2 = V_MUL(_zi, _zi);
+
+        // A lane keeps going while it has neither escaped, cycled nor hit
+        // the limit
+        int running = M_BITS(V_CMPLT(V_ADD(_zr2, _zi2), _bailout))
+                    & M_BITS(V_CMPLT(_iterations, _max_iterations)) & ~periodic;
+        int finished = live & ~running;
+
+        // Step every lane; finished lanes are replaced below, so the wasted
+        // step only costs them this one pass.
+        _iterations = V_ADD(_iterations, _ones);
+        vreal _zr_temp = V_ADD(V_SUB(_zr2, _zi2), _cr);
+        _zi = V_FMADD(V_ADD(_zr, _zr), _zi, _ci);
+        _zr = _zr_temp;
+        passes++;
+
+        // z_n against the z saved at the last power of two n, which is then
+        // replaced once n reaches the next one
+        vreal _dr = V_SUB(_zr, _saved_zr);
+        vreal _di = V_SUB(_zi, _saved_zi);
+        periodic |= M_BITS(V_CMPLT(V_FMADD(_dr, _dr, V_MUL(_di, _di)), _cycle_eps2)) & running;
+        vmask _save = V_CMPLT(V_SUB(_save_at, _ones), _iterations);
+        _saved_zr = V_SELECT(_save, _zr, _saved_zr);
+        _saved_zi = V_SELECT(_save, _zi, _saved_zi);
+        _save_at = V_SELECT(_save, V_ADD(_save_at, _save_at), _save_at);
+
+        if (!finished) continue;
+
+        vscalar mag2_lanes[LANES];
+        V_STOREU(mag2_lanes, V_ADD(_zr2, _zi2));
+        V_STOREU(zr_lanes, _zr);
+        V_STOREU(zi_lanes, _zi);
+        V_STOREU(n_lanes, _iterations);
+        V_STOREU(saved_zr_lanes, _saved_zr);
+        V_STOREU(saved_zi_lanes, _saved_zi);
+        V_STOREU(save_at_lanes, _save_at);
+        for (int l = 0; l < LANES; l++) {
+            if (!(finished & (1 << l))) continue;
+
+            // Undo the increment from the pass that found the lane finished
+            int n = (int)n_lanes[l] - 1;
+            stats->iterations += n;
+            if (periodic & (1 << l)) {
+                n = max_iterations;
+                stats->cycle_exits++;
+            }
+            if (n >= max_iterations) stats->capped++;
+            if (view->smooth && n < max_iterations) {
+                smooth_x[queued] = lane_x[l];
+                smooth_n[queued] = (vscalar)n;
+                smooth_mag2[queued] = mag2_lanes[l];
+                queued++;
+            } else {
+                row[lane_x[l]] = escape_value(n, max_iterations);
+            }
+
+            double cr = 0.0;
+            lane_x[l] = take_pending_pixel(view, ci_base, &next_x, x1, row, &cr);
+            if (lane_x[l] < 0) live &= ~(1 << l);
+            periodic &= ~(1 << l);
+            cr_lanes[l] = (vscalar)cr;
+            zr_lanes[l] = zi_lanes[l] = n_lanes[l] = 0;
+            saved_zr_lanes[l] = saved_zi_lanes[l] = 0;
+            save_at_lanes[l] = 1;
+        }
+        if (queued >= LANES) {
+            KERNEL_FN(store_smooth_values)(row, smooth_x, smooth_n, smooth_mag2, LANES, max_iterations);
+            queued -= LANES;
+            memmove(smooth_x, &smooth_x[LANES], sizeof(int) * queued);
+            memmove(smooth_n, &smooth_n[LANES], sizeof(vscalar) * queued);
+            memmove(smooth_mag2, &smooth_mag2[LANES], sizeof(vscalar) * queued);
+        }
+        _cr = V_LOADU(cr_lanes);
+        _zr = V_LOADU(zr_lanes);
+        _zi = V_LOADU(zi_lanes);
+        _iterations = V_LOADU(n_lanes);
+        _saved_zr = V_LOADU(saved_zr_lanes);
+        _saved_zi = V_LOADU(saved_zi_lanes);
+        _save_at = V_LOADU(save_at_lanes);
+    }
+    if (queued) {
+        KERNEL_FN(store_smooth_values)(row, smooth_x, smooth_n, smooth_mag2, queued, max_iterations);
+    }
+    stats->lane_slots += passes * LANES;
+}
+
+#ifndef KERNEL_NO_PERTURBATION
+/*
+ * Perturbation variant: each pixel iterates its offset d from the reference
+ * orbit Z (the frame center), d' = (2Z + d) d + dc, which stays accurate in
+ * double precision however small dc gets. A lane rebases onto the start of
+ * the orbit (d = z, Z_0 = 0) when |z| < |d|, where d would lose precision,
+ * or at the end of the orbit. Lanes share one orbit index until a rebase
+ * splits them, after which Z is gathered per lane. Pixels start at iteration
+ * series->skip with offsets from the frame's series approximation.
+ *
+ * Cycle detection compares the full z = Z + d against the saved one as
+ * (Z - Z_saved) + (d - d_saved), so a rebase in between doesn't matter, and
+ * scales the difference by 1 / cycle_eps because cycle_eps^2 would
+ * underflow at deep zoom.
+ */
+static inline __attribute__((always_inline)) KERNEL_TARGET void KERNEL_FN(render_span_perturb_impl)(
+        const FrameView* view, int y, int x0, int x1, float* row, KernelStats* stats, const int smooth) {
+    const vreal _bailout = V_SET1(smooth ? SMOOTH_BAILOUT : 4.0);
+    const vreal _zeros = V_SET1(0.0);
+    const vreal _ones = V_SET1(1.0);
+    const int max_iterations = view->max_iterations;
+    const double* orbit_r = view->orbit->zr;
+    const double* orbit_i = view->orbit->zi;
+    const int orbit_end = view->orbit->length - 1;
+    const vreal _orbit_last = V_SET1(orbit_end - 0.5);
+    const SeriesApproximation* series = &view->orbit->series;
+    const vreal _inv_cycle_eps = V_SET1(1.0 / (view->x_scale * CYCLE_TOLERANCE));
+
+    double dci_base = (y - view->height / 2.0) * view->y_scale;
+    double ci_base = view->center_i + dci_base;
+    const vreal _dci = V_SET1(dci_base);
+    vreal _total = V_SET1(0.0);
+
+    for (int x = x0; x < x1; x += LANES) {
+        // Lanes past x1 are computed but never written back.
+        vscalar dcr_lanes[LANES];
+        int all_inside = 1;
+        for (int l = 0; l < LANES; l++) {
+            dcr_lanes[l] = ((x + l) * view->x_step - view->x_origin) * view->x_scale;
+            if (!periodicity_check(view->center_r + dcr_lanes[l], ci_base)) all_inside = 0;
+        }
+        if (all_inside) {
+            for (int l = 0; l < LANES && x + l < x1; l++) row[x + l] = ITER_INSIDE;
+            continue;
+        }
+
+        // All lanes start series->skip iterations in, at the offsets the
+        // series approximation gives
+        vscalar dr_lanes[LANES], di_lanes[LANES];
+        for (int l = 0; l < LANES; l++) {
+            double dr, di;
+            series_initial_offset(series, dcr_lanes[l], dci_base, &dr, &di);
+            dr_lanes[l] = dr;
+            di_lanes[l] = di;
+        }
+        const vreal _dcr = V_LOADU(dcr_lanes);
+        vreal _dr = V_LOADU(dr_lanes), _di = V_LOADU(di_lanes);
+        vreal _iterations = V_SET1(series->skip);
+        vreal _mag2 = _zeros;
+        int m = series->skip;   // Orbit index while the lanes share one
+        int uniform = 1;
+        vreal _ref = _zeros;    // Per-lane orbit indices once they split
+        vreal _saved_Zr = _zeros, _saved_Zi = _zeros, _saved_dr = _zeros, _saved_di = _zeros;
+        int periodic = 0;
+
+        int i = series->skip;
+        for (; i < max_iterations; i++) {
+            vreal _Zr, _Zi;
+            if (uniform) {
+                _Zr = V_SET1(orbit_r[m]);
+                _Zi = V_SET1(orbit_i[m]);
+            } else {
+                vscalar ref_lanes[LANES], zr_lanes[LANES], zi_lanes[LANES];
+                V_STOREU(ref_lanes, _ref);
+                for (int l = 0; l < LANES; l++) {
+                    zr_lanes[l] = orbit_r[(int)ref_lanes[l]];
+                    zi_lanes[l] = orbit_i[(int)ref_lanes[l]];
+                }
+                _Zr = V_LOADU(zr_lanes);
+                _Zi = V_LOADU(zi_lanes);
+            }
+
+            vreal _zr = V_ADD(_Zr, _dr);
+            vreal _zi = V_ADD(_Zi, _di);
+            vreal _z2 = V_FMADD(_zr, _zr, V_MUL(_zi, _zi));
+            vmask _escape_mask = V_CMPLT(_z2, _bailout);
+            if (smooth) _mag2 = V_SELECT(V_CMPLT(_mag2, _bailout), _z2, _mag2);
+
+            // Brent cycle detection on z_i, saved whenever i - skip + 1 is a
+            // power of two
+            int running = M_BITS(_escape_mask);
+            const int k = i - series->skip;
+            if (k > 0) {
+                vreal _er = V_MUL(V_ADD(V_SUB(_Zr, _saved_Zr), V_SUB(_dr, _saved_dr)), _inv_cycle_eps);
+                vreal _ei = V_MUL(V_ADD(V_SUB(_Zi, _saved_Zi), V_SUB(_di, _saved_di)), _inv_cycle_eps);
+                periodic |= M_BITS(V_CMPLT(V_FMADD(_er, _er, V_MUL(_ei, _ei)), _ones)) & running;
+            }
+            running &= ~periodic;
+            if (running == 0) break;
+            _iterations = V_ADD_IF(_iterations, _escape_mask, _ones);
+            if ((k & (k + 1)) == 0) {
+                _saved_Zr = _Zr;
+                _saved_Zi = _Zi;
+                _saved_dr = _dr;
+                _saved_di = _di;
+            }
+
+            // Rebase lanes whose orbit passed closer to 0 than to Z. When every
+            // running lane needs it, or the shared index reached the end of the
+            // orbit, all lanes rebase together (escaped lanes don't care).
+            vmask _rebase = V_CMPLT(_z2, V_FMADD(_dr, _dr, V_MUL(_di, _di)));
+            int rebase = M_BITS(_rebase) & running;
+            if (uniform && (m == orbit_end || rebase == running)) {
+                _dr = _zr;
+                _di = _zi;
+                _Zr = _Zi = _zeros;
+                m = 0;
+            } else if (uniform && rebase) {
+                uniform = 0;
+                _ref = V_SET1((vscalar)m);
+            }
+            if (!uniform) {
+                vmask _at_end = V_CMPLT(_orbit_last, _ref);
+                _dr = V_SELECT(_rebase, _zr, V_SELECT(_at_end, _zr, _dr));
+                _di = V_SELECT(_rebase, _zi, V_SELECT(_at_end, _zi, _di));
+                _Zr = V_SELECT(_rebase, _zeros, V_SELECT(_at_end, _zeros, _Zr));
+                _Zi = V_SELECT(_rebase, _zeros, V_SELECT(_at_end, _zeros, _Zi));
+                _ref = V_SELECT(_rebase, _zeros, V_SELECT(_at_end, _zeros, _ref));
+                _ref = V_ADD(_ref, _ones);
+            }
+            m++;
+
+            // d' = (2Z + d) d + dc
+            vreal _tr = V_ADD(V_ADD(_Zr, _Zr), _dr);
+            vreal _ti = V_ADD(V_ADD(_Zi, _Zi), _di);
+            vreal _dr_next = V_FMADD(_tr, _dr, V_SUB(_dcr, V_MUL(_ti, _di)));
+            _di = V_FMADD(_tr, _di, V_FMADD(_ti, _dr, _dci));
+            _dr = _dr_next;
+        }
+        stats->lane_slots += (Uint64)i * LANES;
+
+        if (x + LANES <= x1) {
+            int capped = KERNEL_FN(store_escape_values)(&row[x], _iterations, _mag2, max_iterations,
+                                                        &_total, smooth);
+            stats->capped += __builtin_popcount(capped | periodic);
+            stats->cycle_exits += __builtin_popcount(periodic);
+            for (int bits = periodic; bits; bits &= bits - 1) {
+                row[x + __builtin_ctz(bits)] = ITER_INSIDE;
+            }
+            continue;
+        }
+
+        // Partial group at the end of the span
+        vscalar n_values[LANES];
+        float values[LANES];
+        V_STOREU(n_values, _iterations);
+        V_STORE_F32(values, KERNEL_FN(escape_values)(_iterations, _mag2, max_iterations, smooth));
+        for (int l = 0; l < LANES && x + l < x1; l++) {
+            int n = (int)n_values[l];
+            stats->iterations += n;
+            if (periodic & (1 << l)) {
+                n = max_iterations;
+                stats->cycle_exits++;
+            }
+            if (n >= max_iterations) stats->capped++;
+            row[x + l] = n >= max_iterations ? ITER_INSIDE : values[l];
+        }
+    }
+    KERNEL_FN(add_total_iterations)(_total, stats);
+}
+
+static KERNEL_TARGET void KERNEL_FN(render_span_perturb)(const FrameView* view, int y, int x0, int x1,
+                                                         float* row, KernelStats* stats) {
+    if (view->smooth) KERNEL_FN(render_span_perturb_impl)(view, y, x0, x1, row, stats, 1);
+    else KERNEL_FN(render_span_perturb_impl)(view, y, x0, x1, row, stats, 0);
+}
+#endif
+
+#ifndef KERNEL_NO_DOUBLE_DOUBLE
+/*
+ * Double-double variant: every coordinate is an unevaluated sum hi + lo of
+ * two doubles, giving about 106 bits of mantissa. Products are made exact
+ * with the fused multiply-add (p = a * b, err = fma(a, b, -p)); sums use the
+ * cheap form that renormalises once, whose error stays far below a pixel
+ * because |z| <= 2 bounds every operand. Escape tests only look at hi.
+ */
+static inline __attribute__((always_inline)) KERNEL_TARGET void KERNEL_FN(dd_two_sum)(
+        vreal a, vreal b, vreal* s, vreal* e) {
+    *s = V_ADD(a, b);
+    vreal bb = V_SUB(*s, a);
+    *e = V_ADD(V_SUB(a, V_SUB(*s, bb)), V_SUB(b, bb));
+}
+
+// (hi, lo) of a + b, renormalised once
+static inline __attribute__((always_inline)) KERNEL_TARGET void KERNEL_FN(dd_add)(
+        vreal ah, vreal al, vreal bh, vreal bl, vreal* rh, vreal* rl) {
+    vreal s, e;
+    KERNEL_FN(dd_two_sum)(ah, bh, &s, &e);
+    e = V_ADD(e, V_ADD(al, bl));
+    *rh = V_ADD(s, e);
+    *rl = V_SUB(e, V_SUB(*rh, s));
+}
+
+static inline __attribute__((always_inline)) KERNEL_TARGET void KERNEL_FN(dd_mul)(
+        vreal ah, vreal al, vreal bh, vreal bl, vreal* rh, vreal* rl) {
+    vreal p = V_MUL(ah, bh);
+    vreal e = V_FMADD(ah, bh, V_SUB(V_SET1(0.0), p));
+    e = V_FMADD(ah, bl, V_FMADD(al, bh, e));
+    *rh = V_ADD(p, e);
+    *rl = V_SUB(e, V_SUB(*rh, p));
+}
+
+static inline __attribute__((always_inline)) KERNEL_TARGET void KERNEL_FN(render_span_dd_impl)(
+        const FrameView* view, int y, int x0, int x1, float* row, KernelStats* stats, const int smooth) {
+    const vreal _bailout = V_SET1(smooth ? SMOOTH_BAILOUT : 4.0);
+    const vreal _zeros = V_SET1(0.0);
+    const vreal _ones = V_SET1(1.0);
+    const int max_iterations = view->max_iterations;
+
+    // c = center + offset, with the offset rounded to a double: its error is
+    // relative to the offset, far below a pixel
+    double dci = (y - view->height / 2.0) * view->y_scale;
+    double ci_base = view->center_i + dci;
+    vreal _cih, _cil;
+    KERNEL_FN(dd_two_sum)(V_SET1(view->center_i), V_SET1(dci), &_cih, &_cil);
+    _cil = V_ADD(_cil, V_SET1(view->center_i_lo));
+    const vreal _center_r = V_SET1(view->center_r);
+    const vreal _center_r_lo = V_SET1(view->center_r_lo);
+    const double cycle_eps = view->x_scale * CYCLE_TOLERANCE;
+    const vreal _cycle_eps2 = V_SET1(cycle_eps * cycle_eps);
+    vreal _total = _zeros;
+
+    for (int x = x0; x < x1; x += LANES) {
+        // Lanes past x1 are computed but never written back.
+        vscalar dcr_lanes[LANES];
+        int all_inside = 1;
+        for (int l = 0; l < LANES; l++) {
+            dcr_lanes[l] = ((x + l) * view->x_step - view->x_origin) * view->x_scale;
+            if (!periodicity_check(view->center_r + dcr_lanes[l], ci_base)) all_inside = 0;
+        }
+        if (all_inside) {
+            for (int l = 0; l < LANES && x + l < x1; l++) row[x + l] = ITER_INSIDE;
+            continue;
+        }
+
+        vreal _crh, _crl;
+        KERNEL_FN(dd_two_sum)(_center_r, V_LOADU(dcr_lanes), &_crh, &_crl);
+        _crl = V_ADD(_crl, _center_r_lo);
+
+        vreal _zrh = _zeros, _zrl = _zeros, _zih = _zeros, _zil = _zeros;
+        vreal _iterations = _zeros;
+        vreal _mag2 = _zeros;
+
+        // Brent cycle detection as in render_span_impl(), with the
+        // difference taken in double-double
+        vreal _srh = _zeros, _srl = _zeros, _sih = _zeros, _sil = _zeros;
+        int periodic = 0;
+
+        int i = 0;
+        for (; i < max_iterations; i++) {
+            vreal _zr2h, _zr2l, _zi2h, _zi2l, _zrzih, _zrzil;
+            KERNEL_FN(dd_mul)(_zrh, _zrl, _zrh, _zrl, &_zr2h, &_zr2l);
+            KERNEL_FN(dd_mul)(_zih, _zil, _zih, _zil, &_zi2h, &_zi2l);
+
+            vreal _z2 = V_ADD(_zr2h, _zi2h);
+            vmask _escape_mask = V_CMPLT(_z2, _bailout);
+            if (smooth) _mag2 = V_SELECT(V_CMPLT(_mag2, _bailout), _z2, _mag2);
+
+            int running = M_BITS(_escape_mask) & ~periodic;
+            if (running == 0) break;
+            _iterations = V_ADD_IF(_iterations, _escape_mask, _ones);
+
+            // z = (zr^2 - zi^2 + cr) + (2 zr zi + ci) i
+            KERNEL_FN(dd_mul)(_zrh, _zrl, _zih, _zil, &_zrzih, &_zrzil);
+            vreal _th, _tl;
+            KERNEL_FN(dd_add)(_zr2h, _zr2l, V_SUB(_zeros, _zi2h), V_SUB(_zeros, _zi2l), &_th, &_tl);
+            KERNEL_FN(dd_add)(_th, _tl, _crh, _crl, &_zrh, &_zrl);
+            KERNEL_FN(dd_add)(V_ADD(_zrzih, _zrzih), V_ADD(_zrzil, _zrzil), _cih, _cil, &_zih, &_zil);
+
+            vreal _dr = V_ADD(V_SUB(_zrh, _srh), V_SUB(_zrl, _srl));
+            vreal _di = V_ADD(V_SUB(_zih, _sih), V_SUB(_zil, _sil));
+            periodic |= M_BITS(V_CMPLT(V_FMADD(_dr, _dr, V_MUL(_di, _di)), _cycle_eps2)) & running;
+            if ((i & (i + 1)) == 0) {
+                _srh = _zrh;
+                _srl = _zrl;
+                _sih = _zih;
+                _sil = _zil;
+            }
+        }
+        stats->lane_slots += (Uint64)i * LANES;
+
+        if (x + LANES <= x1) {
+            int capped = KERNEL_FN(store_escape_values)(&row[x], _iterations, _mag2, max_iterations,
+                                                        &_total, smooth);
+            stats->capped += __builtin_popcount(capped | periodic);
+            stats->cycle_exits += __builtin_popcount(periodic);
+            for (int bits = periodic; bits; bits &= bits - 1) {
+                row[x + __builtin_ctz(bits)] = ITER_INSIDE;
+            }
+            continue;
+        }
+
+        // Partial group at the end of the span
+        vscalar n_values[LANES];
+        float values[LANES];
+        V_STOREU(n_values, _iterations);
+        V_STORE_F32(values, KERNEL_FN(escape_values)(_iterations, _mag2, max_iterations, smooth));
+        for (int l = 0; l < LANES && x + l < x1; l++) {
+            int n = (int)n_values[l];
+            stats->iterations += n;
+            if (periodic & (1 << l)) {
+                n = max_iterations;
+                stats->cycle_exits++;
+            }
+            if (n >= max_iterations) stats->capped++;
+            row[x + l] = n >= max_iterations ? ITER_INSIDE : values[l];
+        }
+    }
+    KERNEL_FN(add_total_iterations)(_total, stats);
+}
+
+static KERNEL_TARGET void KERNEL_FN(render_span_dd)(const FrameView* view, int y, int x0, int x1,
+                                                    float* row, KernelStats* stats) {
+    if (view->smooth) KERNEL_FN(render_span_dd_impl)(view, y, x0, x1, row, stats, 1);
+    else KERNEL_FN(render_span_dd_impl)(view, y, x0, x1, row, stats, 0);
+}
+#endif
+
+#undef KERNEL_CAT_
+#undef KERNEL_CAT
+#undef KERNEL_FN
+#undef KERNEL_SUFFIX
+#undef KERNEL_TARGET
+#undef LANES
+#undef vscalar
+#undef vreal
+#undef vmask
+#undef V_SET1
+#undef V_LOADU
+#undef V_STOREU
+#undef V_STORE_F32
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_FMADD
+#undef V_CMPLT
+#undef M_BITS
+#undef V_ADD_IF
+#undef V_SELECT
+#undef V_DIV
+#undef V_EXPONENT
+#undef V_MANTISSA
+#undef KERNEL_NO_PERTURBATION
+#undef KERNEL_NO_DOUBLE_DOUBLE
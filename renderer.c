@@ -0,0 +1,2365 @@
+/*
+ * renderer.c - Mandelbrot rendering engine (see renderer.h).
+ *
+ * This version is extremely optimized, using:
+ * 1. Multithreading to use all CPU cores, with 64x64 tiles handed out through
+ *    per-thread work-stealing deques.
+ * 2. SIMD instructions on x86, chosen at startup from what the CPU supports:
+ *    SSE2 (2 pixels), AVX2/FMA (4 pixels) or AVX-512F (8 pixels) per vector.
+ * 3. NEON on ARM: 2 doubles per vector on AArch64, 4 floats on ARMv7 while
+ *    single precision resolves the view, with a standard C fallback.
+ * 4. Periodicity checking to skip calculations for large black areas, and an
+ *    optional Mariani-Silver mode that fills regions with a uniform border.
+ * 5. Perturbation around a fixed-point reference orbit for deep zooms.
+ */
+
+#include "renderer.h"
+#include "trace.h"
+#include "topology.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <pthread.h>     // For multithreading
+#include <SDL_cpuinfo.h> // To get the number of CPU cores
+#include <stdatomic.h>   // For dynamic work scheduling
+#include <stdint.h>      // uintptr_t, for aligning buffers
+
+// --- MODIFIED: Conditionally include SIMD headers only for x86/x64 builds ---
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>   // SSE2/AVX2/AVX-512 intrinsics, enabled per kernel
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>    // NEON intrinsics on ARM
+#endif
+
+// --- Constants ---
+const int MAX_ITERATIONS = 255; // Default max iterations for Mandelbrot calculation
+
+// Cycle detection treats an orbit as periodic once it returns within this
+// fraction of a pixel's width of an earlier point.
+#define CYCLE_TOLERANCE 1e-3
+
+// --- Structs ---
+// Simple struct to hold RGB color values
+typedef struct {
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+} Color;
+
+// Work a frame hands to the render threads
+typedef enum {
+    JOB_RENDER,         // Render the scheduled tiles
+    JOB_REPROJECT,      // Resample the previous frame into the scheduled tiles
+    JOB_COLORIZE,       // Color the scheduled tiles from the iteration buffer
+    JOB_TOUCH,          // Zero the scheduled tiles of new buffers (first touch)
+} FrameJob;
+
+// Series approximation of the offset d_n from the reference orbit,
+// d_n ~ A dc + B dc^2 + C dc^3, valid for every pixel of the frame up to
+// iteration `skip`, where the kernels start instead of at 0. Coefficients are
+// stored for the normalised offset u = dc / radius, so they stay in double
+// range however deep the zoom.
+typedef struct {
+    int skip;           // Iterations skipped (0 = series not used)
+    double radius;      // |dc| of the frame's corners
+    double ar, ai;      // A * radius
+    double br, bi;      // B * radius^2
+    double cr, ci;      // C * radius^3
+} SeriesApproximation;
+
+// Orbit Z_0 = 0, Z_1, ... of the reference point (the frame center),
+// computed in fixed point and rounded to doubles for perturbation rendering
+typedef struct {
+    double* zr;
+    double* zi;
+    int length;         // Entries in zr/zi; the last may have escaped
+    int capacity;
+    int limbs;          // Fixed-point precision it was computed with
+    int max_iterations; // Limit it was computed up to
+    HPFixed center_r;   // The reference point
+    HPFixed center_i;
+    SeriesApproximation series; // For the current frame's extent
+} ReferenceOrbit;
+
+// Struct to pass arguments to each rendering thread
+typedef struct {
+    FrameJob job;
+    float* values;      // Escape values of the frame (see IterationBuffer)
+    int stride;         // Values per row of `values`
+    void* pixels;       // ARGB texture the frame is colored into
+    int pitch;
+    double center_r;
+    double center_i;
+    double center_r_lo; // Remainder of the exact center below center_r/i,
+    double center_i_lo; // for the double-double kernels
+    double zoom;
+    int width;          // Size of the frame being rendered, which may be
+    int height;         // smaller than the screen (see ResolutionScaler)
+    int max_iterations;
+    const ReferenceOrbit* orbit;    // Reference orbit for perturbation, or NULL
+    int spacing;        // Pixel spacing of a progressive pass, 0 otherwise
+    int worker_index;   // Which tile deque this thread owns
+    int on_caller;      // Run by the dispatching thread because its own
+                        // thread could not be created (--spawn-threads)
+} ThreadArgs;
+
+// Region of the complex plane covered by a frame, derived from ThreadArgs
+typedef struct {
+    double center_r;
+    double center_i;
+    double center_r_lo; // center_r + center_r_lo is the center to double-
+    double center_i_lo; // double precision (0 unless set from ThreadArgs)
+    double x_scale;     // Complex-plane width of one pixel
+    double y_scale;     // Complex-plane height of one pixel
+    int width;
+    int height;
+    int x_step;         // Column x of a row lies (x * x_step - x_origin) pixels
+    double x_origin;    // right of the center: 1 and width / 2 for a whole
+                        // frame, coarser for a progressive pass (see strided_view)
+    int max_iterations; // Iteration limit for this frame
+    int smooth;         // Store continuous escape values (--smooth)
+    const ReferenceOrbit* orbit;    // Render by perturbation around this
+                                    // orbit of the center, or NULL
+} FrameView;
+
+// Renders the escape values of pixels [x0, x1) of row y into `row` (which
+// points at pixel 0)
+typedef void (*RowKernel)(const FrameView* view, int y, int x0, int x1,
+                          float* row, KernelStats* stats);
+
+// A row kernel plus the CPU feature test gating it (NULL = always available)
+// and the same instruction set's kernels for other precision tiers (see
+// row_kernel_for_view)
+typedef struct {
+    const char* name;
+    RowKernel render_span;
+    RowKernel render_perturbed; // Perturbation kernel
+    RowKernel render_f32;       // Single-precision kernel for shallow views, or NULL
+    RowKernel render_dd;        // Double-double kernel for views just past
+                                // double precision, or NULL
+    SDL_bool (*supported)(void);
+    double min_x_scale; // Finest pixel spacing the kernel's precision resolves
+} KernelInfo;
+
+// One worker's queue of tiles. The pending range [head, tail) is packed into a
+// single word (head in the low half, tail in the high half) so the owner,
+// popping from the head, and thieves, stealing from the tail, race through one
+// compare-and-swap. Padded to a cache line so deques don't share lines.
+typedef struct {
+    atomic_ullong range;
+    char padding[64 - sizeof(atomic_ullong)];
+} TileDeque;
+
+// Frame-wide tiling. Tiles are numbered in row-major order; each worker's
+// deque starts with a contiguous block of them. Pinned workers are numbered
+// node by node, so each NUMA node starts with a contiguous band of the frame.
+typedef struct {
+    int tile_size;      // Tile edge in pixels (--tile)
+    int tiles_x;
+    int tiles_y;
+    TileDeque* deques;
+    int num_deques;
+    const int* tile_list;   // Tiles to render this frame, or NULL for all of them
+    int* worker_node;       // NUMA node each worker is pinned to, or NULL
+} TileSchedule;
+
+static TileSchedule tiles = { .tile_size = 64 };
+
+// Kernel counters of the current frame, summed over all workers
+static KernelStats frame_stats;
+static Uint64 frame_guessed;    // Pixels progressive passes filled without iterating
+static WorkerStats* worker_stats;   // Per worker, for the current frame
+static float* strided_rows;         // Per worker, a row of iter_buffer.stride values
+                                    // of scratch for progressive passes
+static Uint64 frame_dispatch_ticks;  // Wall time of the frame's dispatches
+static pthread_mutex_t frame_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// A pool thread and its fixed worker index
+typedef struct RenderPool RenderPool;
+typedef struct {
+    RenderPool* pool;
+    pthread_t thread;
+    int index;
+} PoolWorker;
+
+// Persistent pool of render workers. Workers sleep on `frame_ready` until the
+// main thread publishes a new frame descriptor and bumps `generation`; the
+// last worker to finish a frame signals `frame_done`.
+struct RenderPool {
+    PoolWorker* workers;
+    int num_threads;
+    pthread_mutex_t lock;
+    pthread_cond_t frame_ready;
+    pthread_cond_t frame_done;
+    ThreadArgs frame;           // Shared per-frame descriptor
+    unsigned long generation;   // Incremented once per published frame
+    int busy_workers;           // Workers still rendering the current frame
+    int shutting_down;
+};
+
+
+int use_mariani_silver = 0;
+int use_progressive = 0;
+int use_smooth_coloring = 0;
+int force_perturbation = 0;
+
+// Per-pixel escape values, kept apart from the texture so a frame can be
+// recolored, reused or exported without iterating it again. Two frames are
+// kept so the previous one stays available while the next is rendered. Rows
+// start on a cache line.
+typedef struct {
+    int width;              // Buffer size in pixels; frames use the top-left
+    int height;             // region, which may be smaller
+    int stride;             // Values per row, a multiple of a cache line
+    float* values[2];       // Frames, indexed by `current`
+    void* storage[2];       // Unaligned allocations behind `values`
+    int current;            // Buffer the frame being rendered goes into
+} IterationBuffer;
+
+static IterationBuffer iter_buffer;
+
+
+// --- Mandelbrot Calculation ---
+/**
+ * @brief Builds the view of a width x height frame centered on (center_r,
+ * center_i), `zoom` times the size of the opening view.
+ */
+static FrameView make_frame_view(double center_r, double center_i, double zoom,
+                                 int width, int height, int max_iterations) {
+    double aspect_ratio = (double)width / (double)height;
+    FrameView view = { .center_r = center_r, .center_i = center_i,
+        .width = width, .height = height, .x_step = 1, .x_origin = width / 2.0,
+        .max_iterations = max_iterations, .smooth = use_smooth_coloring };
+    view.x_scale = (4.0 * aspect_ratio * zoom) / width;
+    view.y_scale = (4.0 * zoom) / width;
+    return view;
+}
+
+/**
+ * @brief Maps the iteration count of an escaped point to a color.
+ */
+Color get_color(int n) {
+    Color color;
+    // Psychedelic coloring
+    color.r = (int)(sin(0.1 * n) * 127 + 128);
+    color.g = (int)(sin(0.1 * n + 2) * 127 + 128);
+    color.b = (int)(sin(0.1 * n + 4) * 127 + 128);
+    return color;
+}
+
+/**
+ * @brief Checks if a point is within the main cardioid or period-2 bulb.
+ * This is a major optimization, allowing us to skip the main loop for many pixels.
+ * @return 1 if the point is in a checked region (and thus in the set), 0 otherwise.
+ */
+int periodicity_check(double cr, double ci) {
+    // Check for period-2 bulb
+    if ((cr + 1.0) * (cr + 1.0) + ci * ci < 0.0625) { // 1/16
+        return 1;
+    }
+    // Check for main cardioid
+    double q = (cr - 0.25) * (cr - 0.25) + ci * ci;
+    if (q * (q + (cr - 0.25)) < 0.25 * ci * ci) {
+        return 1;
+    }
+    return 0;
+}
+
+
+// Escape value of pixels inside the set, or that hit the iteration limit.
+// Any finite value is the iteration count at which the point escaped, so
+// values stay meaningful when the limit changes between frames.
+#define ITER_INSIDE INFINITY
+
+// Smooth coloring runs orbits out to |z|^2 >= 2^SMOOTH_BAILOUT_BITS, where
+// the log-log correction below is continuous to within a small fraction of
+// an iteration.
+#define SMOOTH_BAILOUT_BITS 8
+#define SMOOTH_BAILOUT      ((double)(1 << SMOOTH_BAILOUT_BITS))
+
+/**
+ * @brief Converts a kernel's iteration count into the stored escape value.
+ */
+static inline float escape_value(int n, int max_iterations) {
+    return n >= max_iterations ? ITER_INSIDE : (float)n;
+}
+
+/**
+ * @brief Continuous escape value of a point that first reached
+ * |z|^2 = mag2 >= SMOOTH_BAILOUT after n iterations:
+ * n + 1 - log2(log2(mag2) / log2(SMOOTH_BAILOUT)), which lies in [n, n + 1].
+ */
+static inline float smooth_escape_value(int n, double mag2, int max_iterations) {
+    if (n >= max_iterations) return ITER_INSIDE;
+    return (float)(n + 1.0 + log2(SMOOTH_BAILOUT_BITS) - log2(log2(mag2)));
+}
+
+
+// --- Palette ---
+// Colors are looked up in a table filled from get_color() rather than being
+// computed per pixel. The table covers every iteration count up to `size`
+// so fractional escape values can blend two neighbouring entries; entry
+// `size + 1` holds the interior color, which ITER_INSIDE clamps onto.
+typedef struct {
+    Uint32* colors;     // size + 2 packed ARGB8888 entries
+    int size;
+} Palette;
+
+static Palette palette;
+
+/**
+ * @brief Fills the palette table for iteration counts below `size`.
+ * Called at startup and whenever the palette changes.
+ * @return 0 on success, -1 on allocation failure (the old table is kept).
+ */
+static int palette_build(int size) {
+    Uint32* colors = (Uint32*)realloc(palette.colors, ((size_t)size + 2) * sizeof(Uint32));
+    if (!colors) return -1;
+    for (int n = 0; n <= size; n++) {
+        Color color = get_color(n);
+        colors[n] = (0xFFu << 24) | ((Uint32)color.r << 16) | ((Uint32)color.g << 8) | color.b;
+    }
+    colors[size + 1] = 0xFF000000;  // Black for points inside the set
+    palette.colors = colors;
+    palette.size = size;
+    return 0;
+}
+
+/**
+ * @brief Grows the palette table to cover every count below `max_iterations`.
+ * The table never shrinks, so reprojected values from frames rendered with
+ * a higher limit stay covered. It at least doubles when it grows, so an
+ * adaptive limit creeping upwards does not rebuild it every frame.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int palette_reserve(int max_iterations) {
+    if (max_iterations <= palette.size) return 0;
+    return palette_build(max_iterations > 2 * palette.size ? max_iterations : 2 * palette.size);
+}
+
+/**
+ * @brief Maps an escape value to a packed ARGB8888 pixel (black inside the
+ * set), blending the entries either side of a fractional value. Integer
+ * values give the table entry unchanged.
+ */
+static inline Uint32 escape_value_to_argb(float value) {
+    if (!(value < (float)palette.size)) return palette.colors[palette.size + 1];
+    int n = (int)value;
+    Uint32 f = (Uint32)((value - (float)n) * 256.0f);   // Blend weight, 0..256
+    Uint32 c0 = palette.colors[n], c1 = palette.colors[n + 1];
+    Uint32 rb = (((c0 & 0xFF00FF) * (256 - f) + (c1 & 0xFF00FF) * f) >> 8) & 0xFF00FF;
+    Uint32 g = (((c0 & 0x00FF00) * (256 - f) + (c1 & 0x00FF00) * f) >> 8) & 0x00FF00;
+    return 0xFF000000 | rb | g;
+}
+
+
+// --- Row Kernels ---
+// Every kernel renders the escape values of columns [x0, x1) of row `y` of
+// `view` into `row`, which points at column 0. Columns are the frame's pixels
+// except in the strided views of progressive passes. The fastest kernel the CPU supports is
+// chosen once at startup (see select_kernel).
+
+/**
+ * @brief Standard C kernel, one pixel at a time (ARM / fallback path).
+ */
+static void render_span_scalar(const FrameView* view, int y, int x0, int x1,
+                               float* row, KernelStats* stats) {
+    const int max_iterations = view->max_iterations;
+    const double bailout = view->smooth ? SMOOTH_BAILOUT : 4.0;
+    const double cycle_eps = view->x_scale * CYCLE_TOLERANCE;
+    const double cycle_eps2 = cycle_eps * cycle_eps;
+    double ci = view->center_i + (y - view->height / 2.0) * view->y_scale;
+    for (int x = x0; x < x1; x++) {
+        // Map pixel to complex plane
+        double cr = view->center_r + (x * view->x_step - view->x_origin) * view->x_scale;
+
+        // Check if the point is in a known black region
+        if (periodicity_check(cr, ci)) {
+            row[x] = ITER_INSIDE;
+            continue;
+        }
+
+        // Brent cycle detection: compare against z saved whenever n + 1 is
+        // a power of two; returning close to it means the orbit is periodic.
+        double zr = 0.0, zi = 0.0;
+        double saved_zr = 0.0, saved_zi = 0.0;
+        double mag2 = 0.0;
+        int n = 0, periodic = 0;
+        for (; n < max_iterations; n++) {
+            double zr2 = zr * zr;
+            double zi2 = zi * zi;
+            mag2 = zr2 + zi2;
+            if (mag2 >= bailout) {
+                break;
+            }
+            zi = 2.0 * zr * zi + ci;
+            zr = zr2 - zi2 + cr;
+
+            double dr = zr - saved_zr, di = zi - saved_zi;
+            if (dr * dr + di * di < cycle_eps2) {
+                periodic = 1;
+                break;
+            }
+            if ((n & (n + 1)) == 0) {
+                saved_zr = zr;
+                saved_zi = zi;
+            }
+        }
+        stats->iterations += n;
+        stats->lane_slots += n;
+
+        if (periodic) {
+            n = max_iterations;
+            stats->cycle_exits++;
+        }
+        if (n >= max_iterations) stats->capped++;
+        row[x] = view->smooth ? smooth_escape_value(n, mag2, max_iterations)
+                              : escape_value(n, max_iterations);
+    }
+}
+
+/**
+ * @brief Hands out the next pixel of a span to a lane-refilling kernel.
+ * Pixels in a known black region are written directly and skipped.
+ * @return The pixel's x (with its real coordinate in *cr), or -1 when the
+ * span [*next_x, x1) is exhausted.
+ */
+static int take_pending_pixel(const FrameView* view, double ci, int* next_x, int x1,
+                              float* row, double* cr) {
+    while (*next_x < x1) {
+        int x = (*next_x)++;
+        *cr = view->center_r + (x * view->x_step - view->x_origin) * view->x_scale;
+        if (!periodicity_check(*cr, ci)) return x;
+        row[x] = ITER_INSIDE;
+    }
+    return -1;
+}
+
+/**
+ * @brief Offset from the reference orbit at iteration series->skip of the
+ * pixel at offset (dcr, dci) from the center, evaluated from the series.
+ */
+static inline void series_initial_offset(const SeriesApproximation* series, double dcr, double dci,
+                                         double* dr, double* di) {
+    if (series->skip == 0) {
+        *dr = *di = 0.0;
+        return;
+    }
+    // Horner in u = dc / radius: ((C u + B) u + A) u
+    double ur = dcr / series->radius, ui = dci / series->radius;
+    double tr = series->cr * ur - series->ci * ui + series->br;
+    double ti = series->cr * ui + series->ci * ur + series->bi;
+    double sr = tr * ur - ti * ui + series->ar;
+    double si = tr * ui + ti * ur + series->ai;
+    *dr = sr * ur - si * ui;
+    *di = sr * ui + si * ur;
+}
+
+/**
+ * @brief Standard C perturbation kernel: iterates each pixel's offset from
+ * view->orbit, rebasing onto the start of the orbit when |z| < |d| or the
+ * orbit runs out (see render_span_perturb in mandel_simd.h).
+ */
+static void render_span_perturb_scalar(const FrameView* view, int y, int x0, int x1,
+                                       float* row, KernelStats* stats) {
+    const int max_iterations = view->max_iterations;
+    const double bailout = view->smooth ? SMOOTH_BAILOUT : 4.0;
+    const double* orbit_r = view->orbit->zr;
+    const double* orbit_i = view->orbit->zi;
+    const int orbit_end = view->orbit->length - 1;
+    const double inv_cycle_eps = 1.0 / (view->x_scale * CYCLE_TOLERANCE);
+    double dci = (y - view->height / 2.0) * view->y_scale;
+    for (int x = x0; x < x1; x++) {
+        double dcr = (x * view->x_step - view->x_origin) * view->x_scale;
+        if (periodicity_check(view->center_r + dcr, view->center_i + dci)) {
+            row[x] = ITER_INSIDE;
+            continue;
+        }
+
+        // Start past the iterations the series approximation covers
+        double dr, di, mag2 = 0.0;
+        series_initial_offset(&view->orbit->series, dcr, dci, &dr, &di);
+        const int skip = view->orbit->series.skip;
+        int n = skip, m = n, periodic = 0;
+
+        // Brent cycle detection on z = Z + d, in units of cycle_eps
+        double saved_Zr = 0.0, saved_Zi = 0.0, saved_dr = 0.0, saved_di = 0.0;
+        for (; n < max_iterations; n++) {
+            double zr = orbit_r[m] + dr, zi = orbit_i[m] + di;
+            mag2 = zr * zr + zi * zi;
+            if (mag2 >= bailout) break;
+
+            double Zr = orbit_r[m], Zi = orbit_i[m];
+            int k = n - skip;
+            if (k > 0) {
+                double er = ((Zr - saved_Zr) + (dr - saved_dr)) * inv_cycle_eps;
+                double ei = ((Zi - saved_Zi) + (di - saved_di)) * inv_cycle_eps;
+                if (er * er + ei * ei < 1.0) {
+                    periodic = 1;
+                    break;
+                }
+            }
+            if ((k & (k + 1)) == 0) {
+                saved_Zr = Zr;
+                saved_Zi = Zi;
+                saved_dr = dr;
+                saved_di = di;
+            }
+
+            if (mag2 < dr * dr + di * di || m == orbit_end) {
+                dr = zr;
+                di = zi;
+                Zr = Zi = 0.0;
+                m = 0;
+            }
+            m++;
+
+            // d' = (2Z + d) d + dc
+            double tr = 2.0 * Zr + dr, ti = 2.0 * Zi + di;
+            double dr_next = tr * dr - ti * di + dcr;
+            di = tr * di + ti * dr + dci;
+            dr = dr_next;
+        }
+        stats->iterations += n;
+        stats->lane_slots += n;
+
+        if (periodic) {
+            n = max_iterations;
+            stats->cycle_exits++;
+        }
+        if (n >= max_iterations) stats->capped++;
+        row[x] = view->smooth ? smooth_escape_value(n, mag2, max_iterations)
+                              : escape_value(n, max_iterations);
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// --- SSE2 (x86/x64) Kernel: two pixels per vector ---
+#define KERNEL_SUFFIX     sse2
+#define KERNEL_TARGET     __attribute__((target("sse2")))
+#define KERNEL_NO_DOUBLE_DOUBLE // No fused multiply-add for exact products
+#define LANES             2
+#define vscalar           double
+#define vreal             __m128d
+#define vmask             __m128d
+#define V_SET1(x)         _mm_set1_pd(x)
+#define V_LOADU(p)        _mm_loadu_pd(p)
+#define V_STOREU(p, v)    _mm_storeu_pd(p, v)
+#define V_STORE_F32(p, v) _mm_storel_pi((__m64*)(p), _mm_cvtpd_ps(v))
+#define V_ADD(a, b)       _mm_add_pd(a, b)
+#define V_SUB(a, b)       _mm_sub_pd(a, b)
+#define V_MUL(a, b)       _mm_mul_pd(a, b)
+#define V_FMADD(a, b, c)  _mm_add_pd(_mm_mul_pd(a, b), c)
+#define V_CMPLT(a, b)     _mm_cmplt_pd(a, b)
+#define M_BITS(m)         _mm_movemask_pd(m)
+#define V_ADD_IF(a, m, b) _mm_add_pd(a, _mm_and_pd(m, b))
+#define V_SELECT(m, a, b) _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b))
+#define V_DIV(a, b)       _mm_div_pd(a, b)
+#define V_EXPONENT(x)     _mm_sub_pd(_mm_or_pd(_mm_castsi128_pd(_mm_srli_epi64(_mm_castpd_si128(x), 52)), \
+                                               _mm_set1_pd(0x1p52)), _mm_set1_pd(0x1p52 + 1023.0))
+#define V_MANTISSA(x)     _mm_or_pd(_mm_and_pd(x, _mm_castsi128_pd(_mm_set1_epi64x(0x000FFFFFFFFFFFFFLL))), \
+                                    _mm_set1_pd(1.0))
+#include "mandel_simd.h"
+
+// --- SSE2 single-precision Kernel: four pixels per vector ---
+// Used while float still resolves individual pixels (see row_kernel_for_view).
+#define KERNEL_SUFFIX     sse2_f32
+#define KERNEL_TARGET     __attribute__((target("sse2")))
+#define KERNEL_NO_PERTURBATION  // Offsets need double precision
+#define KERNEL_NO_DOUBLE_DOUBLE
+#define LANES             4
+#define vscalar           float
+#define vreal             __m128
+#define vmask             __m128
+#define V_SET1(x)         _mm_set1_ps(x)
+#define V_LOADU(p)        _mm_loadu_ps(p)
+#define V_STOREU(p, v)    _mm_storeu_ps(p, v)
+#define V_STORE_F32(p, v) _mm_storeu_ps(p, v)
+#define V_ADD(a, b)       _mm_add_ps(a, b)
+#define V_SUB(a, b)       _mm_sub_ps(a, b)
+#define V_MUL(a, b)       _mm_mul_ps(a, b)
+#define V_FMADD(a, b, c)  _mm_add_ps(_mm_mul_ps(a, b), c)
+#define V_CMPLT(a, b)     _mm_cmplt_ps(a, b)
+#define M_BITS(m)         _mm_movemask_ps(m)
+#define V_ADD_IF(a, m, b) _mm_add_ps(a, _mm_and_ps(m, b))
+#define V_SELECT(m, a, b) _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+#define V_DIV(a, b)       _mm_div_ps(a, b)
+#define V_EXPONENT(x)     _mm_sub_ps(_mm_cvtepi32_ps(_mm_srli_epi32(_mm_castps_si128(x), 23)), \
+                                     _mm_set1_ps(127.0f))
+#define V_MANTISSA(x)     _mm_or_ps(_mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x007FFFFF))), \
+                                    _mm_set1_ps(1.0f))
+#include "mandel_simd.h"
+
+// --- AVX2/FMA Kernel: four pixels per vector ---
+#define KERNEL_SUFFIX     avx2
+#define KERNEL_TARGET     __attribute__((target("avx2,fma")))
+#define LANES             4
+#define vscalar           double
+#define vreal             __m256d
+#define vmask             __m256d
+#define V_SET1(x)         _mm256_set1_pd(x)
+#define V_LOADU(p)        _mm256_loadu_pd(p)
+#define V_STOREU(p, v)    _mm256_storeu_pd(p, v)
+#define V_STORE_F32(p, v) _mm_storeu_ps(p, _mm256_cvtpd_ps(v))
+#define V_ADD(a, b)       _mm256_add_pd(a, b)
+#define V_SUB(a, b)       _mm256_sub_pd(a, b)
+#define V_MUL(a, b)       _mm256_mul_pd(a, b)
+#define V_FMADD(a, b, c)  _mm256_fmadd_pd(a, b, c)
+#define V_CMPLT(a, b)     _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#define M_BITS(m)         _mm256_movemask_pd(m)
+#define V_ADD_IF(a, m, b) _mm256_add_pd(a, _mm256_and_pd(m, b))
+#define V_SELECT(m, a, b) _mm256_blendv_pd(b, a, m)
+#define V_DIV(a, b)       _mm256_div_pd(a, b)
+#define V_EXPONENT(x)     _mm256_sub_pd(_mm256_or_pd(_mm256_castsi256_pd(_mm256_srli_epi64(_mm256_castpd_si256(x), 52)), \
+                                                     _mm256_set1_pd(0x1p52)), _mm256_set1_pd(0x1p52 + 1023.0))
+#define V_MANTISSA(x)     _mm256_or_pd(_mm256_and_pd(x, _mm256_castsi256_pd(_mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL))), \
+                                       _mm256_set1_pd(1.0))
+#include "mandel_simd.h"
+
+// --- AVX2/FMA single-precision Kernel: eight pixels per vector ---
+#define KERNEL_SUFFIX     avx2_f32
+#define KERNEL_TARGET     __attribute__((target("avx2,fma")))
+#define KERNEL_NO_PERTURBATION
+#define KERNEL_NO_DOUBLE_DOUBLE
+#define LANES             8
+#define vscalar           float
+#define vreal             __m256
+#define vmask             __m256
+#define V_SET1(x)         _mm256_set1_ps(x)
+#define V_LOADU(p)        _mm256_loadu_ps(p)
+#define V_STOREU(p, v)    _mm256_storeu_ps(p, v)
+#define V_STORE_F32(p, v) _mm256_storeu_ps(p, v)
+#define V_ADD(a, b)       _mm256_add_ps(a, b)
+#define V_SUB(a, b)       _mm256_sub_ps(a, b)
+#define V_MUL(a, b)       _mm256_mul_ps(a, b)
+#define V_FMADD(a, b, c)  _mm256_fmadd_ps(a, b, c)
+#define V_CMPLT(a, b)     _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define M_BITS(m)         _mm256_movemask_ps(m)
+#define V_ADD_IF(a, m, b) _mm256_add_ps(a, _mm256_and_ps(m, b))
+#define V_SELECT(m, a, b) _mm256_blendv_ps(b, a, m)
+#define V_DIV(a, b)       _mm256_div_ps(a, b)
+#define V_EXPONENT(x)     _mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(_mm256_castps_si256(x), 23)), \
+                                        _mm256_set1_ps(127.0f))
+#define V_MANTISSA(x)     _mm256_or_ps(_mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x007FFFFF))), \
+                                       _mm256_set1_ps(1.0f))
+#include "mandel_simd.h"
+
+// --- AVX-512F Kernel: eight pixels per vector ---
+#define KERNEL_SUFFIX     avx512
+#define KERNEL_TARGET     __attribute__((target("avx512f")))
+#define LANES             8
+#define vscalar           double
+#define vreal             __m512d
+#define vmask             __mmask8
+#define V_SET1(x)         _mm512_set1_pd(x)
+#define V_LOADU(p)        _mm512_loadu_pd(p)
+#define V_STOREU(p, v)    _mm512_storeu_pd(p, v)
+#define V_STORE_F32(p, v) _mm256_storeu_ps(p, _mm512_cvtpd_ps(v))
+#define V_ADD(a, b)       _mm512_add_pd(a, b)
+#define V_SUB(a, b)       _mm512_sub_pd(a, b)
+#define V_MUL(a, b)       _mm512_mul_pd(a, b)
+#define V_FMADD(a, b, c)  _mm512_fmadd_pd(a, b, c)
+#define V_CMPLT(a, b)     _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ)
+#define M_BITS(m)         ((int)(m))
+#define V_ADD_IF(a, m, b) _mm512_mask_add_pd(a, m, a, b)
+#define V_SELECT(m, a, b) _mm512_mask_blend_pd(m, b, a)
+#define V_DIV(a, b)       _mm512_div_pd(a, b)
+#define V_EXPONENT(x)     _mm512_getexp_pd(x)
+#define V_MANTISSA(x)     _mm512_getmant_pd(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_src)
+#include "mandel_simd.h"
+
+// --- AVX-512F single-precision Kernel: sixteen pixels per vector ---
+#define KERNEL_SUFFIX     avx512_f32
+#define KERNEL_TARGET     __attribute__((target("avx512f")))
+#define KERNEL_NO_PERTURBATION
+#define KERNEL_NO_DOUBLE_DOUBLE
+#define LANES             16
+#define vscalar           float
+#define vreal             __m512
+#define vmask             __mmask16
+#define V_SET1(x)         _mm512_set1_ps(x)
+#define V_LOADU(p)        _mm512_loadu_ps(p)
+#define V_STOREU(p, v)    _mm512_storeu_ps(p, v)
+#define V_STORE_F32(p, v) _mm512_storeu_ps(p, v)
+#define V_ADD(a, b)       _mm512_add_ps(a, b)
+#define V_SUB(a, b)       _mm512_sub_ps(a, b)
+#define V_MUL(a, b)       _mm512_mul_ps(a, b)
+#define V_FMADD(a, b, c)  _mm512_fmadd_ps(a, b, c)
+#define V_CMPLT(a, b)     _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ)
+#define M_BITS(m)         ((int)(m))
+#define V_ADD_IF(a, m, b) _mm512_mask_add_ps(a, m, a, b)
+#define V_SELECT(m, a, b) _mm512_mask_blend_ps(m, b, a)
+#define V_DIV(a, b)       _mm512_div_ps(a, b)
+#define V_EXPONENT(x)     _mm512_getexp_ps(x)
+#define V_MANTISSA(x)     _mm512_getmant_ps(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_src)
+#include "mandel_simd.h"
+
+static SDL_bool has_avx2_fma(void) {
+    return SDL_HasAVX2() && __builtin_cpu_supports("fma") ? SDL_TRUE : SDL_FALSE;
+}
+
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+// Lane bitmask of a single-precision comparison, for the float NEON kernels
+static inline int neon_movemask_u32(uint32x4_t m) {
+    static const uint32_t lane_bits[4] = { 1, 2, 4, 8 };
+    uint32x4_t bits = vandq_u32(m, vld1q_u32(lane_bits));
+    uint32x2_t sum = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return (int)(vget_lane_u32(sum, 0) | vget_lane_u32(sum, 1));
+}
+
+#if defined(__aarch64__)
+// --- NEON (AArch64) Kernel: two double-precision pixels per vector ---
+static inline int neon_movemask_u64(uint64x2_t m) {
+    return (int)((vgetq_lane_u64(m, 0) & 1) | ((vgetq_lane_u64(m, 1) & 1) << 1));
+}
+
+#define KERNEL_SUFFIX     neon
+#define KERNEL_TARGET
+#define LANES             2
+#define vscalar           double
+#define vreal             float64x2_t
+#define vmask             uint64x2_t
+#define V_SET1(x)         vdupq_n_f64(x)
+#define V_LOADU(p)        vld1q_f64(p)
+#define V_STOREU(p, v)    vst1q_f64(p, v)
+#define V_STORE_F32(p, v) vst1_f32(p, vcvt_f32_f64(v))
+#define V_ADD(a, b)       vaddq_f64(a, b)
+#define V_SUB(a, b)       vsubq_f64(a, b)
+#define V_MUL(a, b)       vmulq_f64(a, b)
+#define V_FMADD(a, b, c)  vfmaq_f64(c, a, b)
+#define V_CMPLT(a, b)     vcltq_f64(a, b)
+#define M_BITS(m)         neon_movemask_u64(m)
+#define V_ADD_IF(a, m, b) vaddq_f64(a, vreinterpretq_f64_u64(vandq_u64(m, vreinterpretq_u64_f64(b))))
+#define V_SELECT(m, a, b) vbslq_f64(m, a, b)
+#define V_DIV(a, b)       vdivq_f64(a, b)
+#define V_EXPONENT(x)     vsubq_f64(vcvtq_f64_u64(vshrq_n_u64(vreinterpretq_u64_f64(x), 52)), vdupq_n_f64(1023.0))
+#define V_MANTISSA(x)     vreinterpretq_f64_u64(vorrq_u64(vandq_u64(vreinterpretq_u64_f64(x), \
+                              vdupq_n_u64(0x000FFFFFFFFFFFFFULL)), vdupq_n_u64(0x3FF0000000000000ULL)))
+#include "mandel_simd.h"
+
+// --- NEON (AArch64) single-precision Kernel: four pixels per vector ---
+#define KERNEL_SUFFIX     neon_f32
+#define KERNEL_TARGET
+#define KERNEL_NO_PERTURBATION  // Offsets need double precision
+#define KERNEL_NO_DOUBLE_DOUBLE
+#define LANES             4
+#define vscalar           float
+#define vreal             float32x4_t
+#define vmask             uint32x4_t
+#define V_SET1(x)         vdupq_n_f32(x)
+#define V_LOADU(p)        vld1q_f32(p)
+#define V_STOREU(p, v)    vst1q_f32(p, v)
+#define V_STORE_F32(p, v) vst1q_f32(p, v)
+#define V_ADD(a, b)       vaddq_f32(a, b)
+#define V_SUB(a, b)       vsubq_f32(a, b)
+#define V_MUL(a, b)       vmulq_f32(a, b)
+#define V_FMADD(a, b, c)  vfmaq_f32(c, a, b)
+#define V_CMPLT(a, b)     vcltq_f32(a, b)
+#define M_BITS(m)         neon_movemask_u32(m)
+#define V_ADD_IF(a, m, b) vaddq_f32(a, vreinterpretq_f32_u32(vandq_u32(m, vreinterpretq_u32_f32(b))))
+#define V_SELECT(m, a, b) vbslq_f32(m, a, b)
+#define V_DIV(a, b)       vdivq_f32(a, b)
+#define V_EXPONENT(x)     vsubq_f32(vcvtq_f32_u32(vshrq_n_u32(vreinterpretq_u32_f32(x), 23)), vdupq_n_f32(127.0f))
+#define V_MANTISSA(x)     vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(x), \
+                              vdupq_n_u32(0x007FFFFFu)), vdupq_n_u32(0x3F800000u)))
+#include "mandel_simd.h"
+
+#else
+// --- NEON (ARMv7) Kernel: four single-precision pixels per vector ---
+// ARMv7 NEON has no double-precision vectors, so this kernel is only used
+// while float still resolves individual pixels (see min_x_scale).
+
+// ARMv7 NEON has no divide: refine the reciprocal estimate twice instead
+static inline float32x4_t neon_div_f32(float32x4_t a, float32x4_t b) {
+    float32x4_t r = vrecpeq_f32(b);
+    r = vmulq_f32(r, vrecpsq_f32(b, r));
+    r = vmulq_f32(r, vrecpsq_f32(b, r));
+    return vmulq_f32(a, r);
+}
+
+#define KERNEL_SUFFIX     neon_f32
+#define KERNEL_TARGET
+#define KERNEL_NO_PERTURBATION  // Offsets need double precision
+#define KERNEL_NO_DOUBLE_DOUBLE
+#define LANES             4
+#define vscalar           float
+#define vreal             float32x4_t
+#define vmask             uint32x4_t
+#define V_SET1(x)         vdupq_n_f32(x)
+#define V_LOADU(p)        vld1q_f32(p)
+#define V_STOREU(p, v)    vst1q_f32(p, v)
+#define V_STORE_F32(p, v) vst1q_f32(p, v)
+#define V_ADD(a, b)       vaddq_f32(a, b)
+#define V_SUB(a, b)       vsubq_f32(a, b)
+#define V_MUL(a, b)       vmulq_f32(a, b)
+#define V_FMADD(a, b, c)  vmlaq_f32(c, a, b)
+#define V_CMPLT(a, b)     vcltq_f32(a, b)
+#define M_BITS(m)         neon_movemask_u32(m)
+#define V_ADD_IF(a, m, b) vaddq_f32(a, vreinterpretq_f32_u32(vandq_u32(m, vreinterpretq_u32_f32(b))))
+#define V_SELECT(m, a, b) vbslq_f32(m, a, b)
+#define V_DIV(a, b)       neon_div_f32(a, b)
+#define V_EXPONENT(x)     vsubq_f32(vcvtq_f32_u32(vshrq_n_u32(vreinterpretq_u32_f32(x), 23)), vdupq_n_f32(127.0f))
+#define V_MANTISSA(x)     vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(x), \
+                              vdupq_n_u32(0x007FFFFFu)), vdupq_n_u32(0x3F800000u)))
+#include "mandel_simd.h"
+#endif
+#endif
+
+// Smallest pixel spacing a single-precision kernel still resolves: a few
+// float ulps at |c| = 2, the edge of the region that can be in the set.
+#define FLOAT_MIN_X_SCALE (16.0 * FLT_EPSILON)
+// The same for double, and for double-double (about 106 bits) with margin
+// for its sums rounding only once
+#define DOUBLE_MIN_X_SCALE 1e-12
+#define DOUBLE_DOUBLE_MIN_X_SCALE 1e-28
+
+// Kernels in order of preference; the first one the CPU supports is used.
+static const KernelInfo kernels[] = {
+#if defined(__x86_64__) || defined(__i386__)
+    { "avx512",        render_span_avx512,        render_span_perturb_avx512,
+      render_span_avx512_f32,        render_span_dd_avx512, SDL_HasAVX512F, 0.0 },
+    { "avx2",          render_span_avx2,          render_span_perturb_avx2,
+      render_span_avx2_f32,          render_span_dd_avx2,   has_avx2_fma,   0.0 },
+    { "sse2",          render_span_sse2,          render_span_perturb_sse2,
+      render_span_sse2_f32,          NULL,                  SDL_HasSSE2,    0.0 },
+    { "avx512-refill", render_span_refill_avx512, render_span_perturb_avx512,
+      render_span_refill_avx512_f32, render_span_dd_avx512, SDL_HasAVX512F, 0.0 },
+    { "avx2-refill",   render_span_refill_avx2,   render_span_perturb_avx2,
+      render_span_refill_avx2_f32,   render_span_dd_avx2,   has_avx2_fma,   0.0 },
+    { "sse2-refill",   render_span_refill_sse2,   render_span_perturb_sse2,
+      render_span_refill_sse2_f32,   NULL,                  SDL_HasSSE2,    0.0 },
+    { "avx512-x2",     render_span_x2_avx512,     render_span_perturb_avx512,
+      render_span_x2_avx512_f32,     render_span_dd_avx512, SDL_HasAVX512F, 0.0 },
+    { "avx512-x4",     render_span_x4_avx512,     render_span_perturb_avx512,
+      render_span_x4_avx512_f32,     render_span_dd_avx512, SDL_HasAVX512F, 0.0 },
+    { "avx2-x2",       render_span_x2_avx2,       render_span_perturb_avx2,
+      render_span_x2_avx2_f32,       render_span_dd_avx2,   has_avx2_fma,   0.0 },
+    { "avx2-x4",       render_span_x4_avx2,       render_span_perturb_avx2,
+      render_span_x4_avx2_f32,       render_span_dd_avx2,   has_avx2_fma,   0.0 },
+    { "sse2-x2",       render_span_x2_sse2,       render_span_perturb_sse2,
+      render_span_x2_sse2_f32,       NULL,                  SDL_HasSSE2,    0.0 },
+    { "sse2-x4",       render_span_x4_sse2,       render_span_perturb_sse2,
+      render_span_x4_sse2_f32,       NULL,                  SDL_HasSSE2,    0.0 },
+#elif defined(__aarch64__)
+    { "neon",          render_span_neon,          render_span_perturb_neon,
+      render_span_neon_f32,          render_span_dd_neon,   NULL,           0.0 },
+    { "neon-refill",   render_span_refill_neon,   render_span_perturb_neon,
+      render_span_refill_neon_f32,   render_span_dd_neon,   NULL,           0.0 },
+    { "neon-x2",       render_span_x2_neon,       render_span_perturb_neon,
+      render_span_x2_neon_f32,       render_span_dd_neon,   NULL,           0.0 },
+    { "neon-x4",       render_span_x4_neon,       render_span_perturb_neon,
+      render_span_x4_neon_f32,       render_span_dd_neon,   NULL,           0.0 },
+#elif defined(__ARM_NEON)
+    { "neon-f32",        render_span_neon_f32,        NULL, NULL, NULL, NULL, FLOAT_MIN_X_SCALE },
+    { "neon-f32-refill", render_span_refill_neon_f32, NULL, NULL, NULL, NULL, FLOAT_MIN_X_SCALE },
+    { "neon-f32-x2",     render_span_x2_neon_f32,     NULL, NULL, NULL, NULL, FLOAT_MIN_X_SCALE },
+    { "neon-f32-x4",     render_span_x4_neon_f32,     NULL, NULL, NULL, NULL, FLOAT_MIN_X_SCALE },
+#endif
+    { "scalar",        render_span_scalar,        render_span_perturb_scalar,
+      NULL,                          NULL,                  NULL,           0.0 },
+};
+static const int num_kernels = sizeof(kernels) / sizeof(kernels[0]);
+
+// Kernel used by the render threads, set once by select_kernel().
+static const KernelInfo* active_kernel = &kernels[sizeof(kernels) / sizeof(kernels[0]) - 1];
+
+static int kernel_supported(const KernelInfo* kernel) {
+    return kernel->supported == NULL || kernel->supported();
+}
+
+/**
+ * @brief Returns the active kernel, or the next supported one in preference
+ * order if the active kernel's precision cannot resolve this view or it has
+ * no perturbation kernel for a view that needs one.
+ */
+static const KernelInfo* kernel_for_view(const FrameView* view) {
+    const KernelInfo* kernel = active_kernel;
+    while (kernel < &kernels[num_kernels - 1]
+           && (view->x_scale < kernel->min_x_scale || !kernel_supported(kernel)
+               || (view->orbit && !kernel->render_perturbed))) {
+        kernel++;
+    }
+    return kernel;
+}
+
+// Render shallow views with the single-precision tier (--f32). Off by default:
+// floats move enough boundary pixels in and out of the set to show.
+int use_single_precision = 0;
+
+/**
+ * @brief Picks the cheapest of `kernel`'s precision tiers that resolves the
+ * pixels of `view`: single precision (twice the lanes) for shallow views
+ * when enabled, then double, then double-double, and the perturbation kernel
+ * whenever the view has an orbit.
+ */
+static RowKernel row_kernel_for_view(const KernelInfo* kernel, const FrameView* view) {
+    if (view->orbit) return kernel->render_perturbed;
+    if (use_single_precision && kernel->render_f32 && view->x_scale >= FLOAT_MIN_X_SCALE) {
+        return kernel->render_f32;
+    }
+    if (kernel->render_dd && view->x_scale < DOUBLE_MIN_X_SCALE) return kernel->render_dd;
+    return kernel->render_span;
+}
+
+/**
+ * @brief Names the precision tier row_kernel_for_view() picks for `view`.
+ */
+static const char* precision_for_view(const KernelInfo* kernel, const FrameView* view) {
+    RowKernel render_span = row_kernel_for_view(kernel, view);
+    if (render_span == kernel->render_perturbed) return "perturbation";
+    if (render_span == kernel->render_f32) return "single";
+    if (render_span == kernel->render_dd) return "double-double";
+    return "double";
+}
+
+// Render views just past double precision with the double-double tier
+// rather than by perturbation (--double-double). Perturbation with series
+// approximation is several times cheaper, so it is the default.
+int use_double_double = 0;
+
+/**
+ * @brief Pixel size below which `kernel` renders by perturbation: past
+ * double, or past its double-double tier when that is enabled.
+ */
+static double perturbation_x_scale(const KernelInfo* kernel) {
+    return use_double_double && kernel->render_dd ? DOUBLE_DOUBLE_MIN_X_SCALE
+                                                  : DOUBLE_MIN_X_SCALE;
+}
+
+/**
+ * @brief Picks the kernel used for rendering.
+ * @param name Kernel to force (from --kernel), or NULL for the fastest supported one.
+ * @return 0 on success, -1 if the requested kernel is unknown or unsupported.
+ */
+int select_kernel(const char* name) {
+    for (int k = 0; k < num_kernels; k++) {
+        if (name && strcmp(name, kernels[k].name) != 0) continue;
+        if (!kernel_supported(&kernels[k])) break;
+        active_kernel = &kernels[k];
+        return 0;
+    }
+    return name ? -1 : 0;
+}
+
+const BenchmarkView benchmark_views[] = {
+    { "overview", "-0.75,0.0", 1.0, 1920, 1080, 256 },
+    { "seahorse", "-0.743643887037151,0.131825904205330", 0.005, 1920, 1080, 1024 },
+    { "interior", "-1.754877666246693,0.0", 0.005, 1280, 720, 2048 },
+    { "deep", "-0.743643887037158704752191506114774,0.131825904205311970493132056385139",
+      1e-15, 640, 360, 4096 },
+};
+const int num_benchmark_views = sizeof(benchmark_views) / sizeof(benchmark_views[0]);
+
+/**
+ * @brief Frame view of `bench_view` at width x height instead of its own
+ * size, with the low parts of the center that the double-double tier uses.
+ */
+static FrameView benchmark_frame_view(const BenchmarkView* bench_view, int width, int height) {
+    HPFixed center_r, center_i;
+    hp_from_string(&center_i, hp_from_string(&center_r, bench_view->center) + 1);
+    FrameView view = make_frame_view(hp_to_double(&center_r), hp_to_double(&center_i),
+                                     bench_view->zoom, width, height, bench_view->max_iterations);
+    hp_add_double(&center_r, -view.center_r);
+    hp_add_double(&center_i, -view.center_i);
+    view.center_r_lo = hp_to_double(&center_r);
+    view.center_i_lo = hp_to_double(&center_i);
+    return view;
+}
+
+enum { BENCH_WIDTH = 256, BENCH_HEIGHT = 160 };
+
+/**
+ * @brief Times one row kernel on a single-threaded BENCH_WIDTH x BENCH_HEIGHT
+ * frame of `view`.
+ * The frame is repeated for at least `min_seconds` so the number is stable.
+ * @return Throughput in Mpixels/s; `stats` receives the work of one frame.
+ */
+static double time_kernel(RowKernel render_span, const FrameView* view, double min_seconds,
+                          KernelStats* stats) {
+    static float bench_values[BENCH_WIDTH * BENCH_HEIGHT];
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    int frames = 0;
+    Uint64 start = SDL_GetPerformanceCounter(), elapsed;
+    do {
+        *stats = (KernelStats){ 0 };
+        for (int y = 0; y < BENCH_HEIGHT; y++) {
+            render_span(view, y, 0, BENCH_WIDTH, &bench_values[y * BENCH_WIDTH], stats);
+        }
+        frames++;
+        elapsed = SDL_GetPerformanceCounter() - start;
+    } while ((double)elapsed < min_seconds * (double)freq);
+    return (double)frames * BENCH_WIDTH * BENCH_HEIGHT / ((double)elapsed / (double)freq) / 1e6;
+}
+
+static double lane_utilisation(const KernelStats* stats) {
+    return stats->lane_slots ? 100.0 * (double)stats->iterations / (double)stats->lane_slots : 100.0;
+}
+
+/**
+ * @brief Times every supported kernel and prints throughput and SIMD lane
+ * utilisation, marking the active kernel.
+ * @param all_views 0 for the quick startup check, which times each kernel
+ * on the seahorse valley view in the precision tier that view renders with;
+ * 1 for the full benchmark mode (--kernel-bench), which times every tier of
+ * every kernel (single, double and double-double) that resolves the pixels
+ * of each benchmark view, and also reports the cost of smooth coloring
+ * relative to banded output. Views are rendered at BENCH_WIDTH x
+ * BENCH_HEIGHT with their --bench iteration limits.
+ */
+void benchmark_kernels(int all_views) {
+    double min_seconds = all_views ? 0.25 : 0.02;
+
+    for (int v = 0; v < num_benchmark_views; v++) {
+        const BenchmarkView* bench_view = &benchmark_views[v];
+        if (!all_views && strcmp(bench_view->name, "seahorse") != 0) continue;
+        if (all_views) printf("View %s (zoom %g):\n", bench_view->name, bench_view->zoom);
+        FrameView view = benchmark_frame_view(bench_view, BENCH_WIDTH, BENCH_HEIGHT);
+        FrameView smooth_view = view;
+        smooth_view.smooth = 1;
+        for (int k = 0; k < num_kernels; k++) {
+            const KernelInfo* kernel = &kernels[k];
+            if (!kernel_supported(kernel)) continue;
+            RowKernel selected = row_kernel_for_view(kernel, &view);
+            const struct { const char* name; RowKernel render_span; double min_x_scale; } tiers[] = {
+                { "single", kernel->render_f32, FLOAT_MIN_X_SCALE },
+                { "double", kernel->render_span, DOUBLE_MIN_X_SCALE },
+                { "double-double", kernel->render_dd, DOUBLE_DOUBLE_MIN_X_SCALE }
+            };
+            for (int t = 0; t < 3; t++) {
+                RowKernel render_span = tiers[t].render_span;
+                if (!render_span || (!all_views && render_span != selected)) continue;
+                if (view.x_scale < tiers[t].min_x_scale || view.x_scale < kernel->min_x_scale) {
+                    continue;
+                }
+                KernelStats stats;
+                double mpixels = time_kernel(render_span, &view, min_seconds, &stats);
+                printf("Kernel %-15s %-13s %8.2f Mpixels/s per thread, %5.1f%% lane utilisation",
+                       kernel->name, tiers[t].name, mpixels, lane_utilisation(&stats));
+                if (all_views) {
+                    KernelStats smooth_stats;
+                    double smooth_mpixels = time_kernel(render_span, &smooth_view, min_seconds,
+                                                        &smooth_stats);
+                    printf(", smooth %8.2f (%+5.1f%% time)", smooth_mpixels,
+                           100.0 * (mpixels / smooth_mpixels - 1.0));
+                }
+                int active = kernel == active_kernel && render_span == selected && !force_perturbation
+                          && view.x_scale >= perturbation_x_scale(kernel);
+                printf("%s\n", active ? "  <- active" : "");
+            }
+        }
+    }
+}
+
+
+// --- Tile Scheduling ---
+static inline unsigned long long pack_tile_range(unsigned head, unsigned tail) {
+    return (unsigned long long)tail << 32 | head;
+}
+
+/**
+ * @brief Allocates one tile deque per worker. Called once at startup.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int tile_schedule_init(int num_workers) {
+    tiles.deques = (TileDeque*)calloc(num_workers, sizeof(TileDeque));
+    if (!tiles.deques) return -1;
+    tiles.num_deques = num_workers;
+    return 0;
+}
+
+/**
+ * @brief Splits a width x height frame into tiles and deals each worker a
+ * contiguous block of them. Must run before the frame is handed out.
+ * @param tile_list Tiles to schedule, or NULL to schedule every tile.
+ * @param num_listed Number of entries in tile_list.
+ */
+static void tile_schedule_reset(int width, int height, const int* tile_list, int num_listed) {
+    tiles.tiles_x = (width + tiles.tile_size - 1) / tiles.tile_size;
+    tiles.tiles_y = (height + tiles.tile_size - 1) / tiles.tile_size;
+    tiles.tile_list = tile_list;
+    unsigned num_tiles = tile_list ? (unsigned)num_listed : (unsigned)(tiles.tiles_x * tiles.tiles_y);
+    for (int w = 0; w < tiles.num_deques; w++) {
+        unsigned head = (unsigned)((unsigned long long)num_tiles * w / tiles.num_deques);
+        unsigned tail = (unsigned)((unsigned long long)num_tiles * (w + 1) / tiles.num_deques);
+        atomic_store(&tiles.deques[w].range, pack_tile_range(head, tail));
+    }
+}
+
+/**
+ * @brief Takes the next tile for `worker`: the head of its own deque, or,
+ * once that is empty and `steal` is set, the tail of another worker's.
+ * @return A tile index, or -1 when there is none left to take.
+ */
+static int take_tile(int worker, int steal) {
+    TileDeque* own = &tiles.deques[worker];
+    unsigned long long range = atomic_load(&own->range);
+    while ((unsigned)range < (unsigned)(range >> 32)) {
+        unsigned head = (unsigned)range, tail = (unsigned)(range >> 32);
+        if (atomic_compare_exchange_weak(&own->range, &range, pack_tile_range(head + 1, tail))) {
+            return tiles.tile_list ? tiles.tile_list[head] : (int)head;
+        }
+    }
+    if (!steal) return -1;
+
+    // With pinned workers, steal from the same node first: its band of the
+    // frame is in memory local to this worker
+    const int* node = tiles.worker_node;
+    for (int local = node ? 1 : 0; local >= 0; local--) {
+        for (int i = 1; i < tiles.num_deques; i++) {
+            int v = (worker + i) % tiles.num_deques;
+            if (node && (node[v] == node[worker]) != local) continue;
+            TileDeque* victim = &tiles.deques[v];
+            range = atomic_load(&victim->range);
+            while ((unsigned)range < (unsigned)(range >> 32)) {
+                unsigned head = (unsigned)range, tail = (unsigned)(range >> 32);
+                if (atomic_compare_exchange_weak(&victim->range, &range,
+                                                 pack_tile_range(head, tail - 1))) {
+                    return tiles.tile_list ? tiles.tile_list[tail - 1] : (int)(tail - 1);
+                }
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Spreads `num_workers` workers over the NUMA nodes in proportion to
+ * their CPUs, numbering them node by node.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int assign_worker_nodes(int num_workers) {
+    tiles.worker_node = (int*)malloc(num_workers * sizeof(int));
+    if (!tiles.worker_node) return -1;
+    // Nodes whose CPU count is unknown count as one CPU
+    int num_nodes = topology_init();
+    long total = 0;
+    for (int n = 0; n < num_nodes; n++) {
+        total += topology_node_cpus(n) > 0 ? topology_node_cpus(n) : 1;
+    }
+    long cpus_before = 0;
+    for (int n = 0; n < num_nodes; n++) {
+        long cpus = topology_node_cpus(n) > 0 ? topology_node_cpus(n) : 1;
+        int first = (int)(num_workers * cpus_before / total);
+        int last = (int)(num_workers * (cpus_before + cpus) / total);
+        for (int w = first; w < last; w++) tiles.worker_node[w] = n;
+        cpus_before += cpus;
+    }
+    return 0;
+}
+
+/**
+ * @brief Pins the calling thread to the node of `worker`, once per thread.
+ */
+static void pin_worker(int worker) {
+    static _Thread_local int pinned;
+    if (pinned) return;
+    pinned = 1;
+    topology_pin_thread(tiles.worker_node[worker]);
+}
+
+
+// --- Mariani-Silver Subdivision ---
+// A region of the escape-time image whose whole border has one value holds
+// that value throughout (away from features smaller than a pixel), so its
+// interior can be filled without iterating. Regions with mixed borders are
+// cut into four by a middle row and column, which become the borders of the
+// quarters, until they are small enough to render directly.
+
+// Regions at or below this edge length are rendered pixel by pixel
+#define MS_MIN_SIZE 6
+
+static inline float* value_row(float* values, int stride, int y) {
+    return values + (size_t)y * stride;
+}
+
+/**
+ * @brief Renders pixels (x, y0) .. (x, y1 - 1) of one column.
+ */
+static void render_column(const FrameView* view, RowKernel render_span, int x, int y0, int y1,
+                          float* values, int stride, KernelStats* stats) {
+    for (int y = y0; y < y1; y++) {
+        render_span(view, y, x, x + 1, value_row(values, stride, y), stats);
+    }
+}
+
+/**
+ * @brief Fills or subdivides [x0, x1) x [y0, y1), whose border pixels are
+ * already rendered.
+ * @return Number of pixels filled without being iterated.
+ */
+static Uint64 subdivide_region(const FrameView* view, RowKernel render_span,
+                               int x0, int y0, int x1, int y1,
+                               float* values, int stride, KernelStats* stats) {
+    if (x1 - x0 <= 2 || y1 - y0 <= 2) return 0;     // No interior
+
+    // Is the border uniform?
+    float value = value_row(values, stride, y0)[x0];
+    int uniform = 1;
+    float* top = value_row(values, stride, y0);
+    float* bottom = value_row(values, stride, y1 - 1);
+    for (int x = x0; x < x1 && uniform; x++) {
+        uniform = top[x] == value && bottom[x] == value;
+    }
+    for (int y = y0 + 1; y < y1 - 1 && uniform; y++) {
+        float* row = value_row(values, stride, y);
+        uniform = row[x0] == value && row[x1 - 1] == value;
+    }
+
+    if (uniform) {
+        for (int y = y0 + 1; y < y1 - 1; y++) {
+            float* row = value_row(values, stride, y);
+            for (int x = x0 + 1; x < x1 - 1; x++) row[x] = value;
+        }
+        return (Uint64)(x1 - x0 - 2) * (Uint64)(y1 - y0 - 2);
+    }
+
+    if (x1 - x0 <= MS_MIN_SIZE || y1 - y0 <= MS_MIN_SIZE) {
+        for (int y = y0 + 1; y < y1 - 1; y++) {
+            render_span(view, y, x0 + 1, x1 - 1, value_row(values, stride, y), stats);
+        }
+        return 0;
+    }
+
+    // Render a middle row and column, then recurse into the four quarters
+    int mx = (x0 + x1) / 2, my = (y0 + y1) / 2;
+    render_span(view, my, x0 + 1, x1 - 1, value_row(values, stride, my), stats);
+    render_column(view, render_span, mx, y0 + 1, my, values, stride, stats);
+    render_column(view, render_span, mx, my + 1, y1 - 1, values, stride, stats);
+
+    return subdivide_region(view, render_span, x0, y0, mx + 1, my + 1, values, stride, stats)
+         + subdivide_region(view, render_span, mx, y0, x1, my + 1, values, stride, stats)
+         + subdivide_region(view, render_span, x0, my, mx + 1, y1, values, stride, stats)
+         + subdivide_region(view, render_span, mx, my, x1, y1, values, stride, stats);
+}
+
+/**
+ * @brief Renders the tile [x0, x1) x [y0, y1), either every pixel or, with
+ * `subdivide`, its border followed by Mariani-Silver subdivision.
+ * @return Number of pixels filled without being iterated.
+ */
+static Uint64 render_tile(const FrameView* view, RowKernel render_span, int subdivide,
+                          int x0, int y0, int x1, int y1,
+                          float* values, int stride, KernelStats* stats) {
+    if (!subdivide) {
+        for (int y = y0; y < y1; y++) {
+            render_span(view, y, x0, x1, value_row(values, stride, y), stats);
+        }
+        return 0;
+    }
+
+    render_span(view, y0, x0, x1, value_row(values, stride, y0), stats);
+    if (y1 - 1 > y0) render_span(view, y1 - 1, x0, x1, value_row(values, stride, y1 - 1), stats);
+    render_column(view, render_span, x0, y0 + 1, y1 - 1, values, stride, stats);
+    if (x1 - 1 > x0) render_column(view, render_span, x1 - 1, y0 + 1, y1 - 1, values, stride, stats);
+    return subdivide_region(view, render_span, x0, y0, x1, y1, values, stride, stats);
+}
+
+/**
+ * @brief Renders every reference view both pixel by pixel and with
+ * Mariani-Silver subdivision, and reports how many pixels differ. A few
+ * mismatches are expected where a filament thinner than a pixel crosses a
+ * region without touching its border. Views past the precision of the
+ * selected kernel are skipped, as they would only compare rounding noise.
+ * @return 0 when the comparison ran, 1 if the buffers could not be allocated.
+ */
+int validate_mariani_silver(void) {
+    enum { VALIDATE_WIDTH = 640, VALIDATE_HEIGHT = 400 };
+    float* reference = (float*)malloc(sizeof(float) * VALIDATE_WIDTH * VALIDATE_HEIGHT);
+    float* subdivided = (float*)malloc(sizeof(float) * VALIDATE_WIDTH * VALIDATE_HEIGHT);
+    if (!reference || !subdivided) {
+        free(reference);
+        free(subdivided);
+        return 1;
+    }
+
+    for (int v = 0; v < num_benchmark_views; v++) {
+        FrameView view = benchmark_frame_view(&benchmark_views[v], VALIDATE_WIDTH, VALIDATE_HEIGHT);
+        const KernelInfo* kernel = kernel_for_view(&view);
+        RowKernel render_span = row_kernel_for_view(kernel, &view);
+
+        // Without an orbit the kernel's own tier bounds how deep it resolves
+        double min_x_scale = render_span == kernel->render_dd ? DOUBLE_DOUBLE_MIN_X_SCALE
+                                                              : DOUBLE_MIN_X_SCALE;
+        if (view.x_scale < min_x_scale) {
+            printf("View %-10s skipped, kernel %s needs perturbation at zoom %g\n",
+                   benchmark_views[v].name, kernel->name, benchmark_views[v].zoom);
+            continue;
+        }
+        KernelStats stats = { 0 };
+        Uint64 filled = 0;
+        for (int y0 = 0; y0 < VALIDATE_HEIGHT; y0 += tiles.tile_size) {
+            for (int x0 = 0; x0 < VALIDATE_WIDTH; x0 += tiles.tile_size) {
+                int x1 = x0 + tiles.tile_size < VALIDATE_WIDTH ? x0 + tiles.tile_size : VALIDATE_WIDTH;
+                int y1 = y0 + tiles.tile_size < VALIDATE_HEIGHT ? y0 + tiles.tile_size : VALIDATE_HEIGHT;
+                render_tile(&view, render_span, 0, x0, y0, x1, y1, reference, VALIDATE_WIDTH, &stats);
+                filled += render_tile(&view, render_span, 1, x0, y0, x1, y1, subdivided, VALIDATE_WIDTH, &stats);
+            }
+        }
+
+        long mismatches = 0;
+        for (int i = 0; i < VALIDATE_WIDTH * VALIDATE_HEIGHT; i++) {
+            if (reference[i] != subdivided[i]) mismatches++;
+        }
+        printf("View %-10s %6ld mismatched pixels, %5.1f%% filled without iterating\n",
+               benchmark_views[v].name, mismatches,
+               100.0 * (double)filled / (VALIDATE_WIDTH * VALIDATE_HEIGHT));
+    }
+
+    free(reference);
+    free(subdivided);
+    return 0;
+}
+
+
+// --- Progressive Rendering ---
+// With --progressive a frame is rendered in passes. The first computes every
+// PROGRESSIVE_SPACING-th pixel of every PROGRESSIVE_SPACING-th row; each
+// later pass halves the spacing and computes the pixels that are new at it.
+// A new pixel whose cell of the previous pass has four equal corners takes
+// their value without being iterated (solid guessing), so smooth regions
+// cost little more than the first pass. After each pass the frame is colored
+// with every pixel taking the value of the pass's pixel at or above-left of
+// it, giving a blocky preview that sharpens pass by pass.
+
+#define PROGRESSIVE_SPACING 8
+
+// Guessable gaps this short between pixels that must be iterated are iterated
+// too: short runs leave most SIMD lanes idle
+#define GUESS_MIN_GAP 4
+
+/**
+ * @brief View whose column i is pixel offset + i * step of `view`'s rows.
+ * Columns land on exactly the coordinates of the whole frame's pixels, so
+ * every pass computes the values a full render would.
+ */
+static FrameView strided_view(const FrameView* view, int step, int offset) {
+    FrameView strided = *view;
+    strided.x_step = step;
+    strided.x_origin = view->x_origin - offset;
+    return strided;
+}
+
+/**
+ * @brief Fills pixel (x, y), new in the pass at `spacing`, from the corners
+ * of its cell in the previous pass if they all hold the same value.
+ * @return 1 if the pixel was filled, 0 if it has to be iterated.
+ */
+static int guess_pixel(float* values, int stride, int width, int height, int spacing,
+                       int x, int y) {
+    int cell = 2 * spacing;
+    int cx0 = x - x % cell, cy0 = y - y % cell;
+    int cx1 = cx0 + cell, cy1 = cy0 + cell;
+    if (cx1 >= width || cy1 >= height) return 0;    // Cell cut by the frame edge
+
+    float value = value_row(values, stride, cy0)[cx0];
+    if (value_row(values, stride, cy0)[cx1] != value
+        || value_row(values, stride, cy1)[cx0] != value
+        || value_row(values, stride, cy1)[cx1] != value) return 0;
+    value_row(values, stride, y)[x] = value;
+    return 1;
+}
+
+/**
+ * @brief Renders the pixels of tile [x0, x1) x [y0, y1) that are new in the
+ * pass at `spacing`, iterating runs of unguessed pixels through strided
+ * views. `strided_row` is scratch for one row of the frame.
+ * @return Number of pixels filled without being iterated.
+ */
+static Uint64 render_pass_tile(const FrameView* view, RowKernel render_span, int spacing,
+                               int x0, int y0, int x1, int y1, float* values, int stride,
+                               float* strided_row, KernelStats* stats) {
+    const int first_pass = spacing == PROGRESSIVE_SPACING;
+    Uint64 guessed = 0;
+    for (int y = (y0 + spacing - 1) / spacing * spacing; y < y1; y += spacing) {
+        // On rows of the previous pass only the columns between its pixels are new
+        int step = spacing, offset = 0;
+        if (!first_pass && y % (2 * spacing) == 0) {
+            step = 2 * spacing;
+            offset = spacing;
+        }
+        FrameView strided = strided_view(view, step, offset);
+        float* row = value_row(values, stride, y);
+        int i0 = x0 <= offset ? 0 : (x0 - offset + step - 1) / step;
+        int i1 = x1 <= offset ? 0 : (x1 - offset + step - 1) / step;
+
+        int run = -1;   // First column of the pending run of pixels to iterate
+        int last = -1;  // Its last column that could not be guessed
+        for (int i = i0; i <= i1; i++) {
+            int iterate = i < i1 && (first_pass
+                || !guess_pixel(values, stride, view->width, view->height, spacing,
+                                offset + i * step, y));
+            if (iterate) {
+                if (run < 0) run = i;
+                else guessed -= i - last - 1;   // Short gaps are iterated with the run
+                last = i;
+                continue;
+            }
+            if (i < i1) guessed++;
+            if (run >= 0 && (i - last > GUESS_MIN_GAP || i == i1)) {
+                render_span(&strided, y, run, last + 1, strided_row, stats);
+                for (int j = run; j <= last; j++) row[offset + j * step] = strided_row[j];
+                run = -1;
+            }
+        }
+    }
+    return guessed;
+}
+
+
+void add_kernel_stats(KernelStats* total, const KernelStats* stats) {
+    total->iterations += stats->iterations;
+    total->lane_slots += stats->lane_slots;
+    total->capped += stats->capped;
+    total->cycle_exits += stats->cycle_exits;
+}
+
+// --- Iteration Buffer ---
+/**
+ * @brief Allocates both iteration frames for up to width x height pixels.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int iteration_buffer_init(int width, int height) {
+    const int line_values = 64 / (int)sizeof(float);
+    iter_buffer.width = width;
+    iter_buffer.height = height;
+    iter_buffer.stride = (width + line_values - 1) / line_values * line_values;
+    for (int b = 0; b < 2; b++) {
+        iter_buffer.storage[b] = malloc((size_t)iter_buffer.stride * height * sizeof(float) + 63);
+        if (!iter_buffer.storage[b]) return -1;
+        iter_buffer.values[b] = (float*)(((uintptr_t)iter_buffer.storage[b] + 63) & ~(uintptr_t)63);
+    }
+    return 0;
+}
+
+static void iteration_buffer_free(void) {
+    for (int b = 0; b < 2; b++) free(iter_buffer.storage[b]);
+}
+
+/**
+ * @brief Zeroes tile [x0, x1) x [y0, y1) of `values` and of the ARGB frame
+ * `pixels`, either of which may be NULL.
+ */
+static void touch_tile(float* values, int stride, void* pixels, int pitch,
+                       int x0, int y0, int x1, int y1) {
+    for (int y = y0; y < y1; y++) {
+        if (values) memset(value_row(values, stride, y) + x0, 0, (size_t)(x1 - x0) * sizeof(float));
+        if (pixels) memset((char*)pixels + (size_t)y * pitch + (size_t)x0 * 4, 0, (size_t)(x1 - x0) * 4);
+    }
+}
+
+/**
+ * @brief Colors tile [x0, x1) x [y0, y1) of the ARGB frame `pixels` from
+ * the escape values in `values`.
+ */
+static void colorize_tile(const float* values, int stride, int x0, int y0, int x1, int y1,
+                          void* pixels, int pitch) {
+    for (int y = y0; y < y1; y++) {
+        const float* src = values + (size_t)y * stride;
+        Uint32* dst = (Uint32*)((Uint8*)pixels + y * pitch);
+        for (int x = x0; x < x1; x++) dst[x] = escape_value_to_argb(src[x]);
+    }
+}
+
+/**
+ * @brief Colors tile [x0, x1) x [y0, y1) after a progressive pass at
+ * `spacing`, every pixel taking the value of the pass's pixel at or
+ * above-left of it.
+ */
+static void colorize_tile_blocks(const float* values, int stride, int spacing,
+                                 int x0, int y0, int x1, int y1, void* pixels, int pitch) {
+    for (int y = y0; y < y1; y++) {
+        const float* src = values + (size_t)(y - y % spacing) * stride;
+        Uint32* dst = (Uint32*)((Uint8*)pixels + y * pitch);
+        int x = x0;
+        while (x < x1) {
+            int block_end = x - x % spacing + spacing < x1 ? x - x % spacing + spacing : x1;
+            Uint32 color = escape_value_to_argb(src[x - x % spacing]);
+            for (; x < block_end; x++) dst[x] = color;
+        }
+    }
+}
+
+
+// --- Reprojection Cache ---
+// Consecutive auto-zoom frames overlap almost entirely, so with --reproject
+// each frame starts as a resampled copy of the previous one's escape values
+// and only a share of its tiles is recomputed: every tile that has no source
+// data, then the tiles whose pixels have gone longest without being
+// computed, nearest to the center first. The whole frame is then colored.
+
+#define AGE_UNKNOWN 255     // Pixel age for pixels with no source data
+
+typedef struct {
+    int enabled;
+    double refresh_fraction;    // Share of tiles recomputed per frame (--reproject)
+    int width;                  // Buffer size in pixels; frames use the top-left
+    int height;                 // region, which may be smaller
+    Uint8* ages[2];             // Frames since each pixel was last computed,
+                                // indexed like iter_buffer.values
+    FrameView prev_view;        // View of the previous iteration frame
+    int have_prev;
+    HPFixed center_r;           // Exact centers of this frame and the previous
+    HPFixed center_i;           // one, whose difference the doubles in the
+    HPFixed prev_center_r;      // views can't resolve at deep zoom
+    HPFixed prev_center_i;
+    double center_delta_r;      // This frame's center minus the previous one's
+    double center_delta_i;
+    Uint8* tile_ages;           // Oldest pixel age per tile after reprojection
+    Uint64* tile_keys;          // Scratch for ordering tiles by priority
+    int* tile_list;             // Tiles chosen for recomputation
+} ReprojectionCache;
+
+static ReprojectionCache reproject;
+
+/**
+ * @brief Allocates age buffers for up to width x height pixels.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int reprojection_init(int width, int height) {
+    size_t num_pixels = (size_t)width * height;
+    size_t max_tiles = (size_t)((width + tiles.tile_size - 1) / tiles.tile_size)
+                     * ((height + tiles.tile_size - 1) / tiles.tile_size);
+    reproject.width = width;
+    reproject.height = height;
+    for (int b = 0; b < 2; b++) {
+        reproject.ages[b] = (Uint8*)malloc(num_pixels);
+        if (!reproject.ages[b]) return -1;
+    }
+    reproject.tile_ages = (Uint8*)malloc(max_tiles);
+    reproject.tile_keys = (Uint64*)malloc(max_tiles * sizeof(Uint64));
+    reproject.tile_list = (int*)malloc(max_tiles * sizeof(int));
+    if (!reproject.tile_ages || !reproject.tile_keys || !reproject.tile_list) return -1;
+    return 0;
+}
+
+static void reprojection_free(void) {
+    for (int b = 0; b < 2; b++) free(reproject.ages[b]);
+    free(reproject.tile_ages);
+    free(reproject.tile_keys);
+    free(reproject.tile_list);
+}
+
+/**
+ * @brief Fills tile [x0, x1) x [y0, y1) of the current buffer with the
+ * nearest pixel of the previous frame, one frame older, and records the
+ * tile's oldest age.
+ */
+static void reproject_tile(const FrameView* view, int tile, int x0, int y0, int x1, int y1) {
+    const FrameView* prev = &reproject.prev_view;
+    const int stride = iter_buffer.stride;
+    float* values = iter_buffer.values[iter_buffer.current];
+    Uint8* ages = reproject.ages[iter_buffer.current];
+    const float* prev_values = iter_buffer.values[!iter_buffer.current];
+    const Uint8* prev_ages = reproject.ages[!iter_buffer.current];
+    Uint8 oldest = 0;
+
+    // Offsets from the previous center, which stay exact however deep the
+    // view is, unlike c itself
+    for (int y = y0; y < y1; y++) {
+        double dci = reproject.center_delta_i + (y - view->height / 2.0) * view->y_scale;
+        int sy = (int)floor(dci / prev->y_scale + prev->height / 2.0 + 0.5);
+        for (int x = x0; x < x1; x++) {
+            double dcr = reproject.center_delta_r + (x - view->width / 2.0) * view->x_scale;
+            int sx = (int)floor(dcr / prev->x_scale + prev->width / 2.0 + 0.5);
+            size_t i = (size_t)y * reproject.width + x;
+            Uint8 age = AGE_UNKNOWN;
+            if (reproject.have_prev && sx >= 0 && sx < prev->width && sy >= 0 && sy < prev->height) {
+                size_t s = (size_t)sy * reproject.width + sx;
+                age = prev_ages[s] < AGE_UNKNOWN - 1 ? prev_ages[s] + 1 : AGE_UNKNOWN - 1;
+                values[(size_t)y * stride + x] = prev_values[(size_t)sy * stride + sx];
+            } else {
+                values[(size_t)y * stride + x] = ITER_INSIDE;
+            }
+            ages[i] = age;
+            if (age > oldest) oldest = age;
+        }
+    }
+    reproject.tile_ages[tile] = oldest;
+}
+
+static int compare_keys_descending(const void* a, const void* b) {
+    Uint64 ka = *(const Uint64*)a, kb = *(const Uint64*)b;
+    return ka < kb ? 1 : ka > kb ? -1 : 0;
+}
+
+/**
+ * @brief Picks the tiles to recompute after reprojection: every tile with
+ * unknown pixels, then the oldest tiles (nearest the center first) until the
+ * refresh fraction is reached.
+ * @return Number of tiles written to reproject.tile_list.
+ */
+static int select_refresh_tiles(void) {
+    int num_tiles = tiles.tiles_x * tiles.tiles_y;
+    int budget = (int)ceil(reproject.refresh_fraction * num_tiles);
+    double cx = (tiles.tiles_x - 1) / 2.0, cy = (tiles.tiles_y - 1) / 2.0;
+
+    // Key: age in the top bits, closeness to the center below, index at the bottom
+    for (int t = 0; t < num_tiles; t++) {
+        double dx = t % tiles.tiles_x - cx, dy = t / tiles.tiles_x - cy;
+        Uint64 closeness = 0xFFFFFu - (Uint64)fmin(dx * dx + dy * dy, (double)0xFFFFF);
+        reproject.tile_keys[t] = (Uint64)reproject.tile_ages[t] << 52 | closeness << 32 | (Uint64)t;
+    }
+    qsort(reproject.tile_keys, num_tiles, sizeof(Uint64), compare_keys_descending);
+
+    int n = 0;
+    for (; n < num_tiles; n++) {
+        int tile = (int)(reproject.tile_keys[n] & 0xFFFFFFFFu);
+        if (n >= budget && reproject.tile_ages[tile] < AGE_UNKNOWN) break;
+        reproject.tile_list[n] = tile;
+    }
+    return n;
+}
+
+/**
+ * @brief Pixels covered by the first `num_listed` tiles of
+ * reproject.tile_list, counting tiles at the right and bottom edges of a
+ * width x height frame only as far as the frame reaches.
+ */
+static long refresh_tile_pixels(int num_listed, int width, int height) {
+    long pixels = 0;
+    for (int n = 0; n < num_listed; n++) {
+        int tile = reproject.tile_list[n];
+        int x0 = (tile % tiles.tiles_x) * tiles.tile_size;
+        int y0 = (tile / tiles.tiles_x) * tiles.tile_size;
+        int x1 = x0 + tiles.tile_size < width ? x0 + tiles.tile_size : width;
+        int y1 = y0 + tiles.tile_size < height ? y0 + tiles.tile_size : height;
+        pixels += (long)(x1 - x0) * (y1 - y0);
+    }
+    return pixels;
+}
+
+/**
+ * @brief Marks every pixel of a freshly rendered tile as current.
+ */
+static void reset_tile_ages(int x0, int y0, int x1, int y1) {
+    Uint8* ages = reproject.ages[iter_buffer.current];
+    for (int y = y0; y < y1; y++) {
+        memset(&ages[(size_t)y * reproject.width + x0], 0, (size_t)(x1 - x0));
+    }
+}
+
+/**
+ * @brief The function executed by each thread.
+ * It works through tiles from its own deque, then steals from the other
+ * workers' deques to even out the end of the frame. Rendered tiles are
+ * colored straight away unless reprojection or a coarse progressive pass
+ * colors the frame afterwards.
+ */
+void* render_thread(void* args) {
+    ThreadArgs* thread_args = (ThreadArgs*)args;
+    Uint64 start = SDL_GetPerformanceCounter();
+    if (tiles.worker_node && !thread_args->on_caller) pin_worker(thread_args->worker_index);
+    if (trace_enabled && !thread_args->on_caller) {
+        char name[32];
+        snprintf(name, sizeof(name), "worker %d", thread_args->worker_index);
+        trace_attach(TRACE_FIRST_WORKER + thread_args->worker_index, name);
+    }
+    static const char* const job_names[] = {
+        [JOB_RENDER] = "render", [JOB_REPROJECT] = "reproject", [JOB_COLORIZE] = "colorize",
+        [JOB_TOUCH] = "touch"
+    };
+    const char* job_name = job_names[thread_args->job];
+
+    // Get parameters from the args struct
+    float* values = thread_args->values;
+    int stride = thread_args->stride;
+    void* pixels = thread_args->pixels;
+    int pitch = thread_args->pitch;
+    FrameView view = make_frame_view(thread_args->center_r, thread_args->center_i,
+                                     thread_args->zoom, thread_args->width, thread_args->height,
+                                     thread_args->max_iterations);
+    view.orbit = thread_args->orbit;
+
+    view.center_r_lo = thread_args->center_r_lo;
+    view.center_i_lo = thread_args->center_i_lo;
+
+    RowKernel render_span = row_kernel_for_view(kernel_for_view(&view), &view);
+    KernelStats stats = { 0 };
+    Uint64 guessed = 0;
+    const int spacing = thread_args->spacing;
+    float* strided_row = &strided_rows[(size_t)thread_args->worker_index * iter_buffer.stride];
+    int tile, num_tiles = 0;
+    // First touch places each page on the node of the worker it was dealt
+    // to, so those tiles are never stolen
+    const int steal = thread_args->job != JOB_TOUCH;
+    while ((tile = take_tile(thread_args->worker_index, steal)) >= 0) {
+        num_tiles++;
+        Uint64 tile_start = trace_clock();
+        int x0 = (tile % tiles.tiles_x) * tiles.tile_size;
+        int y0 = (tile / tiles.tiles_x) * tiles.tile_size;
+        int x1 = x0 + tiles.tile_size < view.width ? x0 + tiles.tile_size : view.width;
+        int y1 = y0 + tiles.tile_size < view.height ? y0 + tiles.tile_size : view.height;
+        if (thread_args->job == JOB_REPROJECT) {
+            reproject_tile(&view, tile, x0, y0, x1, y1);
+        } else if (thread_args->job == JOB_TOUCH) {
+            touch_tile(values, stride, pixels, pitch, x0, y0, x1, y1);
+        } else if (thread_args->job == JOB_COLORIZE) {
+            if (spacing > 1) {
+                colorize_tile_blocks(values, stride, spacing, x0, y0, x1, y1, pixels, pitch);
+            } else {
+                colorize_tile(values, stride, x0, y0, x1, y1, pixels, pitch);
+            }
+        } else if (spacing > 0) {
+            // Coarse passes are colored once every tile is done, since their
+            // blocks can reach into the neighbouring tiles
+            guessed += render_pass_tile(&view, render_span, spacing, x0, y0, x1, y1,
+                                        values, stride, strided_row, &stats);
+            if (spacing == 1) colorize_tile(values, stride, x0, y0, x1, y1, pixels, pitch);
+        } else {
+            render_tile(&view, render_span, use_mariani_silver, x0, y0, x1, y1, values, stride,
+                        &stats);
+            if (reproject.enabled) {
+                reset_tile_ages(x0, y0, x1, y1);
+            } else {
+                colorize_tile(values, stride, x0, y0, x1, y1, pixels, pitch);
+            }
+        }
+        trace_span(job_name, "tile", tile, tile_start);
+    }
+
+    Uint64 end = SDL_GetPerformanceCounter();
+    if (trace_enabled) trace_record("pass", "tiles", num_tiles, start, end);
+    double busy_ms = 1000.0 * (double)(end - start) / (double)SDL_GetPerformanceFrequency();
+    pthread_mutex_lock(&frame_stats_lock);
+    add_kernel_stats(&frame_stats, &stats);
+    frame_guessed += guessed;
+    WorkerStats* worker = &worker_stats[thread_args->worker_index];
+    worker->tiles += num_tiles;
+    worker->iterations += stats.iterations;
+    worker->busy_ms += busy_ms;
+    pthread_mutex_unlock(&frame_stats_lock);
+    return NULL;
+}
+
+
+// --- Render Worker Pool ---
+/**
+ * @brief Body of a long-lived pool worker.
+ * Waits for each new frame generation, renders its share of rows, then goes
+ * back to sleep until the next frame is published.
+ */
+static void* pool_worker(void* args) {
+    PoolWorker* worker = (PoolWorker*)args;
+    RenderPool* pool = worker->pool;
+    unsigned long seen_generation = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        while (pool->generation == seen_generation && !pool->shutting_down) {
+            pthread_cond_wait(&pool->frame_ready, &pool->lock);
+        }
+        if (pool->shutting_down) break;
+
+        seen_generation = pool->generation;
+        ThreadArgs frame = pool->frame;
+        frame.worker_index = worker->index;
+        pthread_mutex_unlock(&pool->lock);
+
+        render_thread(&frame);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy_workers == 0) {
+            pthread_cond_signal(&pool->frame_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/**
+ * @brief Starts `num_threads` persistent render workers.
+ * @return The number of workers actually started (0 on failure).
+ */
+static int render_pool_init(RenderPool* pool, int num_threads) {
+    pool->workers = (PoolWorker*)malloc(num_threads * sizeof(PoolWorker));
+    if (!pool->workers) return 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->frame_ready, NULL);
+    pthread_cond_init(&pool->frame_done, NULL);
+    pool->generation = 0;
+    pool->busy_workers = 0;
+    pool->shutting_down = 0;
+
+    pool->num_threads = 0;
+    for (int i = 0; i < num_threads; i++) {
+        pool->workers[i] = (PoolWorker){ .pool = pool, .index = i };
+        if (pthread_create(&pool->workers[i].thread, NULL, pool_worker, &pool->workers[i]) != 0) break;
+        pool->num_threads++;
+    }
+    return pool->num_threads;
+}
+
+/**
+ * @brief Hands one frame to the pool and blocks until every worker is done.
+ */
+static void render_pool_run(RenderPool* pool, const ThreadArgs* frame) {
+    pthread_mutex_lock(&pool->lock);
+    pool->frame = *frame;
+    pool->busy_workers = pool->num_threads;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->frame_ready);
+    while (pool->busy_workers > 0) {
+        pthread_cond_wait(&pool->frame_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief Wakes all workers with the shutdown flag set and joins them.
+ */
+static void render_pool_destroy(RenderPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->shutting_down = 1;
+    pthread_cond_broadcast(&pool->frame_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->num_threads; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    pthread_cond_destroy(&pool->frame_done);
+    pthread_cond_destroy(&pool->frame_ready);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+}
+
+
+/**
+ * @brief Runs one pass of `frame` over the scheduled tiles, either on the
+ * persistent pool or, with `threads` set (--spawn-threads), on freshly
+ * created threads using `thread_args` as scratch.
+ */
+static void dispatch_frame(const ThreadArgs* frame, RenderPool* pool, int num_threads,
+                           pthread_t* threads, ThreadArgs* thread_args) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    if (!threads) {
+        render_pool_run(pool, frame);
+        frame_dispatch_ticks += SDL_GetPerformanceCounter() - start;
+        return;
+    }
+    for (int i = 0; i < num_threads; i++) {
+        thread_args[i] = *frame;
+        thread_args[i].worker_index = i;
+        thread_args[i].on_caller = pthread_create(&threads[i], NULL, render_thread,
+                                                  &thread_args[i]) != 0;
+    }
+
+    // Work through the deques of threads that failed to start here, since
+    // first-touch tiles are never stolen, then wait for the ones that did
+    for (int i = 0; i < num_threads; i++) {
+        if (thread_args[i].on_caller) render_thread(&thread_args[i]);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        if (!thread_args[i].on_caller) pthread_join(threads[i], NULL);
+    }
+    frame_dispatch_ticks += SDL_GetPerformanceCounter() - start;
+}
+
+
+// --- Perturbation ---
+// Past perturbation_x_scale() the pixel coordinates of a frame no longer fit
+// in the kernel's precision next to the center, so frames are rendered by
+// perturbation: the
+// center's orbit is computed once in fixed point (HPFixed) and every pixel
+// iterates only its small offset from it in double precision. The center is
+// tracked in fixed point so clicks at any depth land where they should.
+
+#define SERIES_PROBES   8       // Border points checking the series approximation
+#define SERIES_TOLERANCE 1e-14  // Largest relative error of a probe's series offset;
+                                // escape counts near the boundary amplify any
+                                // error well beyond double rounding
+
+static int hp_is_negative(const HPFixed* a) {
+    return (a->limb[0] & 0x80000000u) != 0;
+}
+
+static void hp_negate(HPFixed* a, int limbs) {
+    Uint64 carry = 1;
+    for (int k = limbs - 1; k >= 0; k--) {
+        Uint64 t = (Uint64)(Uint32)~a->limb[k] + carry;
+        a->limb[k] = (Uint32)t;
+        carry = t >> 32;
+    }
+}
+
+static void hp_add(HPFixed* r, const HPFixed* a, const HPFixed* b, int limbs) {
+    Uint64 carry = 0;
+    for (int k = limbs - 1; k >= 0; k--) {
+        Uint64 t = (Uint64)a->limb[k] + b->limb[k] + carry;
+        r->limb[k] = (Uint32)t;
+        carry = t >> 32;
+    }
+}
+
+static void hp_sub(HPFixed* r, const HPFixed* a, const HPFixed* b, int limbs) {
+    HPFixed nb = *b;
+    hp_negate(&nb, limbs);
+    hp_add(r, a, &nb, limbs);
+}
+
+/**
+ * @brief r = a * b, truncated to `limbs` limbs. Product columns more than one
+ * limb below the result are skipped, which costs at most a few units in the
+ * last limb.
+ */
+static void hp_mul(HPFixed* r, const HPFixed* a, const HPFixed* b, int limbs) {
+    HPFixed ma = *a, mb = *b;
+    int negative = hp_is_negative(&ma) != hp_is_negative(&mb);
+    if (hp_is_negative(&ma)) hp_negate(&ma, limbs);
+    if (hp_is_negative(&mb)) hp_negate(&mb, limbs);
+
+    // Schoolbook, least significant row first; row i's carry out lands in
+    // column i - 1, which no earlier row has touched
+    Uint32 acc[HP_MAX_LIMBS + 1] = { 0 };
+    for (int i = limbs - 1; i >= 0; i--) {
+        Uint64 carry = 0;
+        for (int j = (limbs - i < limbs - 1 ? limbs - i : limbs - 1); j >= 0; j--) {
+            Uint64 t = (Uint64)ma.limb[i] * mb.limb[j] + acc[i + j] + carry;
+            acc[i + j] = (Uint32)t;
+            carry = t >> 32;
+        }
+        if (i > 0) acc[i - 1] = (Uint32)carry;
+    }
+    memcpy(r->limb, acc, (size_t)limbs * sizeof(Uint32));
+    if (negative) hp_negate(r, limbs);
+}
+
+void hp_from_double(HPFixed* r, double d) {
+    double m = fabs(d);
+    double whole = floor(m);
+    r->limb[0] = (Uint32)whole;
+    m -= whole;
+    for (int k = 1; k < HP_MAX_LIMBS; k++) {
+        m *= 4294967296.0;
+        double digit = floor(m);
+        r->limb[k] = (Uint32)digit;
+        m -= digit;
+    }
+    if (d < 0) hp_negate(r, HP_MAX_LIMBS);
+}
+
+double hp_to_double(const HPFixed* a) {
+    HPFixed m = *a;
+    int negative = hp_is_negative(&m);
+    if (negative) hp_negate(&m, HP_MAX_LIMBS);
+    // Four limbs from the leading nonzero one cover a double's mantissa
+    int first = 0;
+    while (first < HP_MAX_LIMBS - 1 && m.limb[first] == 0) first++;
+    int last = first + 3 < HP_MAX_LIMBS - 1 ? first + 3 : HP_MAX_LIMBS - 1;
+    double d = 0.0;
+    for (int k = last; k >= first; k--) d = d / 4294967296.0 + m.limb[k];
+    d = ldexp(d, -32 * first);
+    return negative ? -d : d;
+}
+
+void hp_add_double(HPFixed* a, double d) {
+    HPFixed b;
+    hp_from_double(&b, d);
+    hp_add(a, a, &b, HP_MAX_LIMBS);
+}
+
+/**
+ * @brief The low half of `a` as a double-double whose high half is `hi`.
+ */
+static double hp_low_part(const HPFixed* a, double hi) {
+    HPFixed low = *a;
+    hp_add_double(&low, -hi);
+    return hp_to_double(&low);
+}
+
+const char* hp_from_string(HPFixed* r, const char* s) {
+    const char* p = s;
+    int negative = *p == '-';
+    if (*p == '-' || *p == '+') p++;
+    Uint32 whole = 0;
+    int digits = 0;
+    for (; *p >= '0' && *p <= '9'; p++, digits++) whole = whole * 10 + (Uint32)(*p - '0');
+    const char* frac_start = p;
+    if (*p == '.') {
+        frac_start = ++p;
+        for (; *p >= '0' && *p <= '9'; p++) digits++;
+    }
+    if (digits == 0) return NULL;
+
+    // Fraction digits from the last one back: f = (digit + f) / 10, where
+    // the digit goes into the (otherwise zero) integer limb
+    HPFixed f = { { 0 } };
+    for (const char* d = p - 1; d >= frac_start && *d != '.'; d--) {
+        f.limb[0] = (Uint32)(*d - '0');
+        Uint64 remainder = 0;
+        for (int k = 0; k < HP_MAX_LIMBS; k++) {
+            Uint64 t = (remainder << 32) | f.limb[k];
+            f.limb[k] = (Uint32)(t / 10);
+            remainder = t % 10;
+        }
+    }
+    f.limb[0] = whole;
+    if (negative) hp_negate(&f, HP_MAX_LIMBS);
+    *r = f;
+    return p;
+}
+
+/**
+ * @brief Makes `orbit` the orbit of (center_r, center_i), precise enough for
+ * pixels of size x_scale and long enough for max_iterations. The previous
+ * orbit is kept when it already qualifies, so an auto-zoom recomputes it only
+ * every few hundred frames.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int reference_orbit_update(ReferenceOrbit* orbit, const HPFixed* center_r,
+                                  const HPFixed* center_i, double x_scale, int max_iterations) {
+    // 64 guard bits below the pixel size, plus the integer limb
+    int limbs = (int)ceil((-log2(x_scale) + 64.0) / 32.0) + 1;
+    if (limbs > HP_MAX_LIMBS) limbs = HP_MAX_LIMBS;
+    int escaped = orbit->length > 0 && orbit->length - 1 < orbit->max_iterations;
+    if (orbit->length > 0 && orbit->limbs >= limbs
+        && (escaped || orbit->max_iterations >= max_iterations)
+        && memcmp(&orbit->center_r, center_r, sizeof(HPFixed)) == 0
+        && memcmp(&orbit->center_i, center_i, sizeof(HPFixed)) == 0) {
+        return 0;
+    }
+
+    // Headroom so a slowly rising iteration limit or zoom doesn't trigger a
+    // recomputation every frame
+    limbs = limbs + 2 < HP_MAX_LIMBS ? limbs + 2 : HP_MAX_LIMBS;
+    int target = max_iterations + max_iterations / 4;
+    if (target + 1 > orbit->capacity) {
+        double* zr = (double*)realloc(orbit->zr, (size_t)(target + 1) * sizeof(double));
+        if (zr) orbit->zr = zr;
+        double* zi = (double*)realloc(orbit->zi, (size_t)(target + 1) * sizeof(double));
+        if (zi) orbit->zi = zi;
+        if (!zr || !zi) return -1;
+        orbit->capacity = target + 1;
+    }
+
+    HPFixed zr = { { 0 } }, zi = { { 0 } }, zr2, zi2, zrzi;
+    orbit->zr[0] = orbit->zi[0] = 0.0;
+    orbit->length = 1;
+    for (int n = 1; n <= target; n++) {
+        hp_mul(&zr2, &zr, &zr, limbs);
+        hp_mul(&zi2, &zi, &zi, limbs);
+        hp_mul(&zrzi, &zr, &zi, limbs);
+        hp_sub(&zr, &zr2, &zi2, limbs);
+        hp_add(&zr, &zr, center_r, limbs);
+        hp_add(&zi, &zrzi, &zrzi, limbs);
+        hp_add(&zi, &zi, center_i, limbs);
+
+        double dr = hp_to_double(&zr), di = hp_to_double(&zi);
+        orbit->zr[n] = dr;
+        orbit->zi[n] = di;
+        orbit->length = n + 1;
+        if (dr * dr + di * di >= SMOOTH_BAILOUT) break;
+    }
+    orbit->limbs = limbs;
+    orbit->max_iterations = target;
+    orbit->center_r = *center_r;
+    orbit->center_i = *center_i;
+    return 0;
+}
+
+/**
+ * @brief Fits orbit->series to a width x height frame of pixel size
+ * (x_scale, y_scale) and picks how many iterations it can skip. The
+ * coefficients are stepped alongside the exact offsets of probe points on the
+ * frame's border, where the truncated series is least accurate, and the skip
+ * is the last iteration at which the series still matches every probe to
+ * within SERIES_TOLERANCE. A probe that would escape or need a rebase also
+ * ends the series.
+ */
+static void series_approximation_update(ReferenceOrbit* orbit, double x_scale, double y_scale,
+                                        int width, int height, int max_iterations) {
+    // Corners and edge midpoints, in units of the half-frame size
+    static const signed char probe_pos[SERIES_PROBES][2] = {
+        { -1, -1 }, { 0, -1 }, { 1, -1 }, { -1, 0 }, { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 }
+    };
+    SeriesApproximation* series = &orbit->series;
+    double half_w = width / 2.0 * x_scale, half_h = height / 2.0 * y_scale;
+    double radius = sqrt(half_w * half_w + half_h * half_h);
+    series->skip = 0;
+    series->radius = radius;
+    if (radius == 0.0) return;
+
+    double ur[SERIES_PROBES], ui[SERIES_PROBES], dr[SERIES_PROBES], di[SERIES_PROBES];
+    for (int p = 0; p < SERIES_PROBES; p++) {
+        ur[p] = probe_pos[p][0] * half_w / radius;
+        ui[p] = probe_pos[p][1] * half_h / radius;
+        dr[p] = di[p] = 0.0;
+    }
+
+    // A_0 = B_0 = C_0 = 0; the pixel may not start on the orbit's last entry,
+    // which can have escaped
+    double ar = 0.0, ai = 0.0, br = 0.0, bi = 0.0, cr = 0.0, ci = 0.0;
+    int last = orbit->length - 2 < max_iterations ? orbit->length - 2 : max_iterations;
+    for (int n = 0; n < last; n++) {
+        double Zr = orbit->zr[n], Zi = orbit->zi[n];
+
+        // A' = 2ZA + 1, B' = 2ZB + A^2, C' = 2ZC + 2AB (scaled by radius^k)
+        double ar_next = 2.0 * (Zr * ar - Zi * ai) + radius;
+        double ai_next = 2.0 * (Zr * ai + Zi * ar);
+        double br_next = 2.0 * (Zr * br - Zi * bi) + ar * ar - ai * ai;
+        double bi_next = 2.0 * (Zr * bi + Zi * br) + 2.0 * ar * ai;
+        double cr_next = 2.0 * (Zr * cr - Zi * ci + ar * br - ai * bi);
+        double ci_next = 2.0 * (Zr * ci + Zi * cr + ar * bi + ai * br);
+        ar = ar_next; ai = ai_next;
+        br = br_next; bi = bi_next;
+        cr = cr_next; ci = ci_next;
+
+        double Zr_next = orbit->zr[n + 1], Zi_next = orbit->zi[n + 1];
+        SeriesApproximation trial = { n + 1, radius, ar, ai, br, bi, cr, ci };
+        for (int p = 0; p < SERIES_PROBES; p++) {
+            // d' = (2Z + d) d + dc
+            double dcr = ur[p] * radius, dci = ui[p] * radius;
+            double tr = 2.0 * Zr + dr[p], ti = 2.0 * Zi + di[p];
+            double dr_next = tr * dr[p] - ti * di[p] + dcr;
+            di[p] = tr * di[p] + ti * dr[p] + dci;
+            dr[p] = dr_next;
+
+            double zr = Zr_next + dr[p], zi = Zi_next + di[p];
+            double z2 = zr * zr + zi * zi, d2 = dr[p] * dr[p] + di[p] * di[p];
+            if (z2 >= 4.0 || z2 < d2) return;
+
+            double sr, si;
+            series_initial_offset(&trial, dcr, dci, &sr, &si);
+            double er = sr - dr[p], ei = si - di[p];
+            if (er * er + ei * ei > SERIES_TOLERANCE * SERIES_TOLERANCE * d2) return;
+        }
+        *series = trial;
+    }
+}
+
+
+// --- Frame Rendering ---
+static RenderPool pool;
+static pthread_t* spawn_threads;    // With --spawn-threads, else NULL
+static ThreadArgs* spawn_args;
+static int num_workers;
+static ReferenceOrbit orbit;        // Reference orbit of deep frames
+
+/**
+ * @brief Has every worker zero its own tiles of a new `values` and/or
+ * `pixels` buffer (either may be NULL), so that with pinned workers each
+ * page is first touched, and so placed, on the node that renders it.
+ */
+static void first_touch(float* values, int stride, void* pixels, int pitch, int width, int height) {
+    ThreadArgs touch = { .job = JOB_TOUCH, .values = values, .stride = stride,
+                         .pixels = pixels, .pitch = pitch, .zoom = 1.0,
+                         .width = width, .height = height, .max_iterations = 1 };
+    tile_schedule_reset(width, height, NULL, 0);
+    dispatch_frame(&touch, &pool, num_workers, spawn_threads, spawn_args);
+}
+
+int renderer_init(const RendererConfig* config) {
+    tiles.tile_size = config->tile_size;
+    num_workers = config->num_threads > 0 ? config->num_threads : 1;
+    if (config->spawn_per_frame) {
+        spawn_threads = (pthread_t*)malloc(num_workers * sizeof(pthread_t));
+        spawn_args = (ThreadArgs*)malloc(num_workers * sizeof(ThreadArgs));
+        if (!spawn_threads || !spawn_args) return 0;
+    } else {
+        num_workers = render_pool_init(&pool, num_workers);
+        if (num_workers < 1) return 0;
+    }
+    if (tile_schedule_init(num_workers) != 0) return 0;
+    worker_stats = (WorkerStats*)calloc(num_workers, sizeof(WorkerStats));
+    if (!worker_stats) return 0;
+    if (iteration_buffer_init(config->max_width, config->max_height) != 0) return 0;
+    strided_rows = (float*)malloc((size_t)num_workers * iter_buffer.stride * sizeof(float));
+    if (!strided_rows) return 0;
+    if (config->pin_workers) {
+        if (assign_worker_nodes(num_workers) != 0) return 0;
+        for (int b = 0; b < 2; b++) {
+            first_touch(iter_buffer.values[b], iter_buffer.stride, NULL, 0,
+                        config->max_width, config->max_height);
+        }
+    }
+    if (palette_build(MAX_ITERATIONS) != 0) return 0;
+    if (config->reproject > 0.0) {
+        reproject.enabled = 1;
+        reproject.refresh_fraction = config->reproject;
+        if (reprojection_init(config->max_width, config->max_height) != 0) return 0;
+    }
+    return num_workers;
+}
+
+// Frame between renderer_begin_frame() and renderer_end_frame()
+static ThreadArgs frame_args;
+static FrameView frame_view;
+static int frame_progressive;   // Rendered in progressive passes
+static int frame_spacing;       // Spacing the frame is complete to, 0 before any pass
+static long frame_pixels;       // Pixels iterated, or to be (see FrameResult)
+static const char* frame_kernel;
+static const char* frame_precision;
+
+int renderer_begin_frame(const FrameRequest* request) {
+    const int width = request->width, height = request->height;
+    if (palette_reserve(request->max_iterations) != 0) {
+        fprintf(stderr, "Out of memory for a %d-entry palette.\n", request->max_iterations);
+        return -1;
+    }
+
+    // Past the kernel's precision tiers, render around the center's exact orbit
+    double center_r = hp_to_double(&request->center_r);
+    double center_i = hp_to_double(&request->center_i);
+    const ReferenceOrbit* frame_orbit = NULL;
+    frame_view = make_frame_view(center_r, center_i, request->zoom, width, height,
+                                 request->max_iterations);
+    if (force_perturbation
+        || frame_view.x_scale < perturbation_x_scale(kernel_for_view(&frame_view))) {
+        Uint64 orbit_start = trace_clock();
+        if (reference_orbit_update(&orbit, &request->center_r, &request->center_i,
+                                   frame_view.x_scale, request->max_iterations) != 0) {
+            fprintf(stderr, "Out of memory for a %d-iteration reference orbit.\n",
+                    request->max_iterations);
+            return -1;
+        }
+        series_approximation_update(&orbit, frame_view.x_scale, frame_view.y_scale,
+                                    width, height, request->max_iterations);
+        trace_span("reference orbit", "max_iterations", request->max_iterations, orbit_start);
+        frame_orbit = &orbit;
+    }
+
+    frame_args = (ThreadArgs){ .job = JOB_RENDER,
+        .values = iter_buffer.values[iter_buffer.current], .stride = iter_buffer.stride,
+        .center_r = center_r, .center_i = center_i,
+        .center_r_lo = hp_low_part(&request->center_r, center_r),
+        .center_i_lo = hp_low_part(&request->center_i, center_i), .zoom = request->zoom,
+        .width = width, .height = height,
+        .max_iterations = request->max_iterations, .orbit = frame_orbit };
+    FrameView kernel_view = frame_view;
+    kernel_view.orbit = frame_orbit;
+    const KernelInfo* kernel = kernel_for_view(&kernel_view);
+    frame_kernel = kernel->name;
+    frame_precision = precision_for_view(kernel, &kernel_view);
+    memset(worker_stats, 0, num_workers * sizeof(WorkerStats));
+    frame_dispatch_ticks = 0;
+
+    if (reproject.enabled) {
+        HPFixed delta;
+        reproject.center_r = request->center_r;
+        reproject.center_i = request->center_i;
+        hp_sub(&delta, &reproject.center_r, &reproject.prev_center_r, HP_MAX_LIMBS);
+        reproject.center_delta_r = hp_to_double(&delta);
+        hp_sub(&delta, &reproject.center_i, &reproject.prev_center_i, HP_MAX_LIMBS);
+        reproject.center_delta_i = hp_to_double(&delta);
+    }
+
+    // Reprojection already starts every frame from a full image
+    frame_progressive = use_progressive && !reproject.enabled;
+    frame_spacing = 0;
+    frame_pixels = (long)width * height;
+    return 0;
+}
+
+int renderer_render_pass(void* pixels, int pitch, int preview) {
+    const int width = frame_args.width, height = frame_args.height;
+    frame_args.pixels = pixels;
+    frame_args.pitch = pitch;
+
+    if (frame_progressive) {
+        // Render the pixels new at this spacing, then color the frame
+        frame_spacing = frame_spacing == 0 ? PROGRESSIVE_SPACING : frame_spacing / 2;
+        frame_args.spacing = frame_spacing;
+        frame_args.job = JOB_RENDER;
+        tile_schedule_reset(width, height, NULL, 0);
+        dispatch_frame(&frame_args, &pool, num_workers, spawn_threads, spawn_args);
+        if (frame_spacing > 1 && preview) {
+            frame_args.job = JOB_COLORIZE;
+            tile_schedule_reset(width, height, NULL, 0);
+            dispatch_frame(&frame_args, &pool, num_workers, spawn_threads, spawn_args);
+        }
+        return frame_spacing;
+    }
+
+    // Deal out this frame's tiles and hand the frame to the workers
+    if (reproject.enabled) {
+        // Resample the previous frame, recompute the stalest tiles, then
+        // color the whole frame
+        frame_args.job = JOB_REPROJECT;
+        tile_schedule_reset(width, height, NULL, 0);
+        dispatch_frame(&frame_args, &pool, num_workers, spawn_threads, spawn_args);
+
+        int num_refresh = select_refresh_tiles();
+        frame_args.job = JOB_RENDER;
+        tile_schedule_reset(width, height, reproject.tile_list, num_refresh);
+        dispatch_frame(&frame_args, &pool, num_workers, spawn_threads, spawn_args);
+
+        frame_args.job = JOB_COLORIZE;
+        tile_schedule_reset(width, height, NULL, 0);
+        dispatch_frame(&frame_args, &pool, num_workers, spawn_threads, spawn_args);
+        frame_pixels = refresh_tile_pixels(num_refresh, width, height);
+
+        reproject.prev_view = frame_view;
+        reproject.prev_center_r = reproject.center_r;
+        reproject.prev_center_i = reproject.center_i;
+        reproject.have_prev = 1;
+    } else {
+        tile_schedule_reset(width, height, NULL, 0);
+        dispatch_frame(&frame_args, &pool, num_workers, spawn_threads, spawn_args);
+    }
+    frame_spacing = 1;
+    return frame_spacing;
+}
+
+void renderer_end_frame(FrameResult* result) {
+    // Whatever part of the dispatches a worker was not busy, it spent waking
+    // up or waiting for the others to finish
+    double dispatch_ms = 1000.0 * (double)frame_dispatch_ticks
+        / (double)SDL_GetPerformanceFrequency();
+    for (int i = 0; i < num_workers; i++) {
+        double idle_ms = dispatch_ms - worker_stats[i].busy_ms;
+        worker_stats[i].idle_ms = idle_ms > 0.0 ? idle_ms : 0.0;
+    }
+
+    result->stats = frame_stats;
+    result->pixels_rendered = frame_pixels - (long)frame_guessed;
+    result->kernel = frame_kernel;
+    result->precision = frame_precision;
+    result->num_workers = num_workers;
+    result->workers = worker_stats;
+    frame_stats = (KernelStats){ 0 };
+    frame_guessed = 0;
+    iter_buffer.current = !iter_buffer.current;
+}
+
+void renderer_place_buffer(void* pixels, int pitch, int width, int height) {
+    if (tiles.worker_node) first_touch(NULL, 0, pixels, pitch, width, height);
+}
+
+int renderer_render_frame(const FrameRequest* request, void* pixels, int pitch,
+                          FrameResult* result) {
+    if (renderer_begin_frame(request) != 0) return -1;
+    while (renderer_render_pass(pixels, pitch, 0) > 1) continue;
+    renderer_end_frame(result);
+    return 0;
+}
+
+void renderer_shutdown(void) {
+    if (spawn_threads || spawn_args) {
+        free(spawn_threads);
+        free(spawn_args);
+    } else if (pool.workers) {
+        render_pool_destroy(&pool);
+    }
+    free(tiles.deques);
+    free(tiles.worker_node);
+    free(worker_stats);
+    free(strided_rows);
+    iteration_buffer_free();
+    free(palette.colors);
+    if (reproject.enabled) reprojection_free();
+    free(orbit.zr);
+    free(orbit.zi);
+
+    // Ready for another renderer_init()
+    pool = (RenderPool){ 0 };
+    spawn_threads = NULL;
+    spawn_args = NULL;
+    tiles = (TileSchedule){ .tile_size = 64 };
+    worker_stats = NULL;
+    strided_rows = NULL;
+    iter_buffer = (IterationBuffer){ 0 };
+    palette = (Palette){ 0 };
+    reproject = (ReprojectionCache){ 0 };
+    orbit = (ReferenceOrbit){ 0 };
+}
@@ -0,0 +1,193 @@
+/*
+ * renderer.h - Mandelbrot rendering engine.
+ *
+ * Renders frames of the Mandelbrot set into ARGB8888 pixel buffers using the
+ * SIMD row kernels (mandel_simd.h) on a pool of worker threads. Nothing here
+ * opens a window or needs SDL_Init(), so the same engine drives the
+ * interactive viewer and headless rendering (--render).
+ *
+ * The engine is a single instance: set the options below, call
+ * renderer_init(), render any number of frames with renderer_render_frame()
+ * (or pass by pass, see renderer_begin_frame()), then call
+ * renderer_shutdown().
+ */
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <SDL.h>    // Uint32/Uint64, CPU feature tests and timers
+
+extern const int MAX_ITERATIONS;   // Default iteration limit
+
+// High-precision fixed-point number: limb[0] is the integer part and limb[k]
+// holds the k-th group of 32 bits below the binary point. Negative values
+// are two's complement across all limbs in use.
+#define HP_MAX_LIMBS 36
+typedef struct {
+    Uint32 limb[HP_MAX_LIMBS];
+} HPFixed;
+
+// Work counters accumulated by a kernel. A lane slot is one lane of one
+// vector iteration, so iterations / lane_slots is the SIMD lane utilisation.
+typedef struct {
+    Uint64 iterations;  // Escape-time iterations that did useful work
+    Uint64 lane_slots;  // Lane-iterations issued, useful or idle
+    Uint64 capped;      // Iterated pixels reported as inside the set
+    Uint64 cycle_exits; // ... of which cycle detection stopped early
+} KernelStats;
+
+// Engine setup, fixed for the lifetime of the renderer
+typedef struct {
+    int num_threads;        // Render workers
+    int spawn_per_frame;    // Create threads per frame instead of a pool (--spawn-threads)
+    int tile_size;          // Edge of the square tiles workers take (--tile)
+    double reproject;       // Share of tiles recomputed per frame, 0 = off (--reproject)
+    int pin_workers;        // Pin workers to NUMA nodes, each rendering a band of
+                            // the frame in node-local memory (--pin)
+    int max_width;          // Largest frame that will be rendered
+    int max_height;
+} RendererConfig;
+
+// One frame to render
+typedef struct {
+    HPFixed center_r;       // Exact center of the view
+    HPFixed center_i;
+    double zoom;            // 1 is the opening view, 4 units across
+    int width;              // Size in pixels, at most the configured maximum
+    int height;
+    int max_iterations;
+} FrameRequest;
+
+// Work of one render worker over a frame
+typedef struct {
+    int tiles;              // Tiles taken, counting every pass over the frame
+    Uint64 iterations;      // Escape-time iterations executed
+    double busy_ms;         // Time spent on tiles, from wake-up to running dry
+    double idle_ms;         // Rest of the frame's passes: waking up and waiting
+                            // at the join for the slowest worker
+} WorkerStats;
+
+// Outcome of one frame
+typedef struct {
+    KernelStats stats;      // Kernel counters summed over all workers
+    long pixels_rendered;   // Pixels actually iterated (fewer when reprojecting
+                            // or guessing progressively)
+    const char* kernel;     // Kernel family that rendered the frame
+    const char* precision;  // Its tier: "single", "double", "double-double"
+                            // or "perturbation"
+    int num_workers;
+    const WorkerStats* workers; // Per worker, valid until the next frame
+} FrameResult;
+
+// Per-frame options, read on every frame
+extern int use_mariani_silver;  // Fill tile regions whose border is uniform (--mariani-silver)
+extern int use_progressive;     // Coarse-to-fine passes with solid guessing (--progressive)
+extern int use_smooth_coloring; // Continuous escape values (--smooth)
+extern int force_perturbation;  // Perturbation at every zoom (--perturb)
+extern int use_double_double;   // Double-double tier before perturbation (--double-double)
+extern int use_single_precision; // Single-precision tier for shallow views (--f32)
+
+// Zooms are deepest here; perturbation offsets reach the bottom of double range
+#define DEEPEST_ZOOM 1e-290
+
+/**
+ * @brief Picks the row kernel family used for rendering.
+ * @param name Kernel to force (from --kernel), or NULL for the fastest supported one.
+ * @return 0 on success, -1 if the requested kernel is unknown or unsupported.
+ */
+int select_kernel(const char* name);
+
+// Reference views measured by --bench, --kernel-bench and --numa-bench and
+// checked by --validate-ms. Sizes and iteration limits are fixed so results
+// compare across machines and builds.
+typedef struct {
+    const char* name;
+    const char* center;     // "R,I", parsed at full precision
+    double zoom;
+    int width;              // Frame size for --bench; the other modes use
+    int height;             // their own
+    int max_iterations;
+} BenchmarkView;
+
+extern const BenchmarkView benchmark_views[];
+extern const int num_benchmark_views;
+
+/**
+ * @brief Prints the throughput of every supported kernel, on every benchmark
+ * view with `all_views` (--kernel-bench) or on the seahorse view only.
+ */
+void benchmark_kernels(int all_views);
+
+/**
+ * @brief Compares Mariani-Silver rendering against brute force on the
+ * benchmark views and prints the differing pixel counts.
+ * @return 0 when the comparison ran, 1 if the buffers could not be allocated.
+ */
+int validate_mariani_silver(void);
+
+/**
+ * @brief Starts the workers and allocates the frame buffers.
+ * @return The number of render threads in use, 0 on failure.
+ */
+int renderer_init(const RendererConfig* config);
+
+/**
+ * @brief With pin_workers, has the workers first-touch a newly allocated
+ * width x height frame buffer, so each page lands on the NUMA node of the
+ * workers that will color it. Does nothing otherwise.
+ */
+void renderer_place_buffer(void* pixels, int pitch, int width, int height);
+
+/**
+ * @brief Renders `request` into `pixels` (ARGB8888, `pitch` bytes per row),
+ * blocking until the frame is complete.
+ * @return 0 on success, -1 if the frame's palette or reference orbit could
+ * not be allocated.
+ */
+int renderer_render_frame(const FrameRequest* request, void* pixels, int pitch,
+                          FrameResult* result);
+
+/**
+ * @brief Starts rendering `request` in passes, so a caller can show the frame
+ * as it refines: call renderer_render_pass() until it returns 1, then
+ * renderer_end_frame(). renderer_render_frame() does exactly this.
+ * @return 0 on success, -1 if the frame's palette or reference orbit could
+ * not be allocated.
+ */
+int renderer_begin_frame(const FrameRequest* request);
+
+/**
+ * @brief Renders the next pass of the frame. With use_progressive set, the
+ * first pass samples every 8th pixel and each later pass halves the spacing;
+ * otherwise one pass renders it all. The final pass colors the frame into
+ * `pixels`; with `preview` set, coarse passes also color it, in blocks the
+ * size of their spacing. Each pass may color into a different buffer.
+ * @return The pixel spacing the frame is now complete to; 1 when finished.
+ */
+int renderer_render_pass(void* pixels, int pitch, int preview);
+
+/**
+ * @brief Finishes the frame, storing its counters in `result`.
+ */
+void renderer_end_frame(FrameResult* result);
+
+/**
+ * @brief Stops the workers and frees everything renderer_init() allocated.
+ */
+void renderer_shutdown(void);
+
+void add_kernel_stats(KernelStats* total, const KernelStats* stats);
+
+// Fixed-point helpers for tracking the view center
+void hp_from_double(HPFixed* r, double d);
+double hp_to_double(const HPFixed* a);
+void hp_add_double(HPFixed* a, double d);
+
+/**
+ * @brief Parses a decimal number such as "-0.7436438870371587047" into `r`
+ * without going through double, so centers keep every digit given.
+ * @return Pointer past the parsed number, or NULL if there was none.
+ */
+const char* hp_from_string(HPFixed* r, const char* s);
+
+#endif // RENDERER_H
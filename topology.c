@@ -0,0 +1,92 @@
+/*
+ * topology.c - NUMA node discovery from /sys and thread pinning.
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE     // cpu_set_t and pthread_setaffinity_np
+#include <sched.h>
+#include <pthread.h>
+#endif
+#include "topology.h"
+#include <stdio.h>
+
+#ifdef __linux__
+#define TOPOLOGY_MAX_NODES 64
+
+// Usable CPUs of each node with any, in node order
+static cpu_set_t node_cpus[TOPOLOGY_MAX_NODES];
+static int num_nodes;
+
+/**
+ * @brief Reads a /sys list such as "0-7,16-23" into `set`.
+ * @return 0 on success, -1 if the file is missing or malformed.
+ */
+static int read_cpu_list(const char* path, cpu_set_t* set) {
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+    CPU_ZERO(set);
+    int first, last, status = 0;
+    while (fscanf(file, "%d", &first) == 1) {
+        last = first;
+        int c = fgetc(file);
+        if (c == '-') {
+            if (fscanf(file, "%d", &last) != 1) {
+                status = -1;
+                break;
+            }
+            c = fgetc(file);
+        }
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) CPU_SET(cpu, set);
+        if (c != ',') break;
+    }
+    fclose(file);
+    return status;
+}
+
+int topology_init(void) {
+    cpu_set_t allowed, online, cpus;
+    num_nodes = 0;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return 1;
+
+    // "online" lists node numbers in the same format as CPU lists
+    if (read_cpu_list("/sys/devices/system/node/online", &online) == 0) {
+        for (int node = 0; node < CPU_SETSIZE && num_nodes < TOPOLOGY_MAX_NODES; node++) {
+            if (!CPU_ISSET(node, &online)) continue;
+            char path[64];
+            snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+            if (read_cpu_list(path, &cpus) != 0) continue;
+            CPU_AND(&node_cpus[num_nodes], &cpus, &allowed);
+            if (CPU_COUNT(&node_cpus[num_nodes]) > 0) num_nodes++;
+        }
+    }
+    if (num_nodes == 0) {
+        node_cpus[0] = allowed;
+        num_nodes = 1;
+    }
+    return num_nodes;
+}
+
+int topology_node_cpus(int node) {
+    return node >= 0 && node < num_nodes ? CPU_COUNT(&node_cpus[node]) : 0;
+}
+
+int topology_pin_thread(int node) {
+    if (node < 0 || node >= num_nodes) return -1;
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &node_cpus[node]) == 0 ? 0 : -1;
+}
+
+#else
+int topology_init(void) {
+    return 1;
+}
+
+int topology_node_cpus(int node) {
+    (void)node;
+    return 0;
+}
+
+int topology_pin_thread(int node) {
+    (void)node;
+    return -1;
+}
+#endif
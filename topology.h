@@ -0,0 +1,29 @@
+/*
+ * topology.h - NUMA nodes of the machine and pinning threads to them.
+ *
+ * On Linux the nodes and their CPUs are read from /sys, limited to the CPUs
+ * this process may run on. Elsewhere, or without NUMA information, the
+ * machine is a single node and threads are not pinned.
+ */
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+/**
+ * @brief Reads the NUMA layout. Safe to call more than once.
+ * @return The number of nodes with usable CPUs, at least 1.
+ */
+int topology_init(void);
+
+/**
+ * @brief Number of usable CPUs on `node` (0 .. topology_init() - 1).
+ */
+int topology_node_cpus(int node);
+
+/**
+ * @brief Restricts the calling thread to the CPUs of `node`.
+ * @return 0 on success, -1 if pinning is unsupported or failed.
+ */
+int topology_pin_thread(int node);
+
+#endif // TOPOLOGY_H
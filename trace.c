@@ -0,0 +1,104 @@
+/*
+ * trace.c - Per-thread span recording and Chrome trace-event JSON output.
+ */
+
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// One span of a track
+typedef struct {
+    const char* name;
+    const char* arg_name;   // NULL when the span has no argument
+    int arg;
+    Uint64 start;           // Performance counter
+    Uint64 end;
+} TraceEvent;
+
+// Ring buffer of one thread's spans. `count` only grows, so the newest span
+// is at (count - 1) % TRACE_TRACK_EVENTS.
+typedef struct {
+    char name[32];
+    TraceEvent* events;     // Allocated when a thread first attaches
+    Uint64 count;
+} TraceTrack;
+
+int trace_enabled = 0;
+
+static FILE* trace_file;
+static TraceTrack* tracks;
+static int num_tracks;
+static Uint64 trace_start;
+static _Thread_local TraceTrack* current_track;
+
+int trace_open(const char* path, int num_workers) {
+    trace_file = fopen(path, "w");
+    if (!trace_file) return -1;
+    num_tracks = TRACE_FIRST_WORKER + num_workers;
+    tracks = (TraceTrack*)calloc(num_tracks, sizeof(TraceTrack));
+    if (!tracks) {
+        fclose(trace_file);
+        return -1;
+    }
+    trace_start = SDL_GetPerformanceCounter();
+    trace_enabled = 1;
+    return 0;
+}
+
+void trace_attach(int track, const char* name) {
+    if (!trace_enabled || track < 0 || track >= num_tracks) return;
+    TraceTrack* t = &tracks[track];
+    if (!t->events) {
+        t->events = (TraceEvent*)malloc(TRACE_TRACK_EVENTS * sizeof(TraceEvent));
+        if (!t->events) return;     // Untraced, rather than failing the render
+    }
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    current_track = t;
+}
+
+void trace_record(const char* name, const char* arg_name, int arg, Uint64 start, Uint64 end) {
+    TraceTrack* t = current_track;
+    if (!t) return;
+    t->events[t->count % TRACE_TRACK_EVENTS] = (TraceEvent){ name, arg_name, arg, start, end };
+    t->count++;
+}
+
+int trace_close(void) {
+    if (!trace_enabled) return 0;
+    trace_enabled = 0;
+
+    // Complete ("X") events in microseconds since trace_open(), after a name
+    // and sort order for each track
+    const double us_per_tick = 1e6 / (double)SDL_GetPerformanceFrequency();
+    fprintf(trace_file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(trace_file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"fractal\"}}");
+    for (int i = 0; i < num_tracks; i++) {
+        TraceTrack* t = &tracks[i];
+        if (!t->events) continue;
+        fprintf(trace_file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                "\"args\":{\"name\":\"%s\"}}", i, t->name);
+        fprintf(trace_file, ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                "\"args\":{\"sort_index\":%d}}", i, i);
+        Uint64 first = t->count > TRACE_TRACK_EVENTS ? t->count - TRACE_TRACK_EVENTS : 0;
+        if (first > 0) {
+            fprintf(stderr, "Trace: %s kept its last %d of %llu spans.\n", t->name,
+                    TRACE_TRACK_EVENTS, (unsigned long long)t->count);
+        }
+        for (Uint64 k = first; k < t->count; k++) {
+            const TraceEvent* e = &t->events[k % TRACE_TRACK_EVENTS];
+            fprintf(trace_file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                    "\"ts\":%.3f,\"dur\":%.3f", e->name, i,
+                    (double)(e->start - trace_start) * us_per_tick,
+                    (double)(e->end - e->start) * us_per_tick);
+            if (e->arg_name) fprintf(trace_file, ",\"args\":{\"%s\":%d}", e->arg_name, e->arg);
+            fprintf(trace_file, "}");
+        }
+        free(t->events);
+    }
+    fprintf(trace_file, "\n]}\n");
+    int status = ferror(trace_file) ? -1 : 0;
+    if (fclose(trace_file) != 0) status = -1;
+    free(tracks);
+    tracks = NULL;
+    return status;
+}
@@ -0,0 +1,64 @@
+/*
+ * trace.h - Timeline of render activity in Chrome trace-event format.
+ *
+ * With tracing on (--trace), each thread records spans (a name, a start and
+ * an end time) into a ring buffer of its own "track", without locks: a track
+ * has one writer at a time and is only read by trace_close(), after the
+ * writers are done. The newest TRACE_TRACK_EVENTS spans of every track are
+ * written out as a JSON file that chrome://tracing and Perfetto open.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <SDL.h>    // Uint64 and the performance counter
+
+// Spans each track keeps; older ones are overwritten
+#define TRACE_TRACK_EVENTS (1 << 16)
+
+// Tracks: the main thread, the thread feeding or draining it (viewer render
+// thread or sequence writer), then one per render worker
+enum { TRACE_MAIN, TRACE_PIPELINE, TRACE_FIRST_WORKER };
+
+extern int trace_enabled;
+
+/**
+ * @brief Starts tracing into `path`, with tracks for `num_workers` workers.
+ * @return 0 on success, -1 if the file could not be created.
+ */
+int trace_open(const char* path, int num_workers);
+
+/**
+ * @brief Makes `track` the calling thread's track and names it. Threads
+ * created per frame attach to the same track as their predecessor.
+ */
+void trace_attach(int track, const char* name);
+
+/**
+ * @brief Records a span on the calling thread's track. `name` and `arg_name`
+ * must be string literals; `arg_name` labels `arg` in the viewer, NULL for
+ * no argument.
+ */
+void trace_record(const char* name, const char* arg_name, int arg, Uint64 start, Uint64 end);
+
+/**
+ * @brief Writes the recorded spans to the trace file and stops tracing.
+ * @return 0 on success (or with tracing off), -1 on a write error.
+ */
+int trace_close(void);
+
+/**
+ * @brief Reads the performance counter with tracing on, 0 otherwise.
+ */
+static inline Uint64 trace_clock(void) {
+    return trace_enabled ? SDL_GetPerformanceCounter() : 0;
+}
+
+/**
+ * @brief Records a span from `start` until now, if tracing.
+ */
+static inline void trace_span(const char* name, const char* arg_name, int arg, Uint64 start) {
+    if (trace_enabled) trace_record(name, arg_name, arg, start, SDL_GetPerformanceCounter());
+}
+
+#endif // TRACE_H